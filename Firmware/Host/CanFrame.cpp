@@ -0,0 +1,136 @@
+#include "CanFrame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+unsigned can_frame_bits(const CanFrame &frame) {
+    // Bits from SOF through the data field, as sent before stuffing
+    std::vector<uint8_t> bits;
+    auto push = [&](uint32_t value, int count) {
+        for (int i = count - 1; i >= 0; i--) bits.push_back((value >> i) & 1);
+    };
+    push(0, 1);                     // SOF
+    push(frame.id >> 18, 11);       // Base identifier
+    push(1, 1);                     // SRR
+    push(1, 1);                     // IDE
+    push(frame.id & 0x3FFFF, 18);   // Identifier extension
+    push(0, 1);                     // RTR
+    push(0, 2);                     // r1, r0
+    push(frame.len, 4);             // DLC
+    for (int i = 0; i < frame.len; i++) push(frame.data[i], 8);
+
+    // CRC-15 over the same bits
+    uint16_t crc = 0;
+    for (uint8_t b : bits) {
+        bool top = ((crc >> 14) & 1) ^ b;
+        crc = (crc << 1) & 0x7FFF;
+        if (top) crc ^= 0x4599;
+    }
+    push(crc, 15);
+
+    // A stuff bit follows every 5 equal bits, and counts towards the next run
+    unsigned stuffed = 0;
+    int run = 0;
+    uint8_t last = 2;
+    for (uint8_t b : bits) {
+        if (b == last) {
+            run++;
+        } else {
+            last = b;
+            run = 1;
+        }
+        if (run == 5) {
+            stuffed++;
+            last = !b;
+            run = 1;
+        }
+    }
+    // CRC delimiter, ACK slot and delimiter, EOF, interframe space
+    return bits.size() + stuffed + 1 + 2 + 7 + 3;
+}
+
+std::string gc_format(const CanFrame &frame) {
+    char buf[40];
+    int n = snprintf(buf, sizeof(buf), ":X%08XN", (unsigned)frame.id);
+    for (int i = 0; i < frame.len; i++) n += snprintf(buf + n, sizeof(buf) - n, "%02X", frame.data[i]);
+    snprintf(buf + n, sizeof(buf) - n, ";");
+    return buf;
+}
+
+bool gc_parse(const std::string &line, CanFrame *frame) {
+    size_t start = line.find(":X");
+    if (start == std::string::npos) return false;
+    size_t n = line.find('N', start);
+    size_t end = line.find(';', start);
+    if (n == std::string::npos || end == std::string::npos || n > end) return false;
+    frame->id = strtoul(line.substr(start + 2, n - start - 2).c_str(), nullptr, 16) & 0x1FFFFFFF;
+    size_t hex = end - n - 1;
+    if (hex % 2 || hex > 16) return false;
+    frame->len = hex / 2;
+    for (int i = 0; i < frame->len; i++) {
+        frame->data[i] = strtoul(line.substr(n + 1 + 2 * i, 2).c_str(), nullptr, 16);
+    }
+    return true;
+}
+
+namespace lcc {
+
+CanFrame rid(uint16_t alias) {
+    return CanFrame{0x10700000U | alias, 0, {}};
+}
+
+CanFrame amd(uint16_t alias, uint64_t nodeId) {
+    CanFrame f{0x10701000U | alias, 6, {}};
+    put_u48(f.data, nodeId);
+    return f;
+}
+
+uint16_t control_type(const CanFrame &frame) {
+    if (frame.id & 0x08000000) return 0;
+    uint8_t type = (frame.id >> 24) & 0x7;
+    if (type != 0) return 0x1000 | type;
+    return (frame.id >> 12) & 0xFFF;
+}
+
+CanFrame message(uint16_t mti, uint16_t src, const uint8_t *data, uint8_t len) {
+    CanFrame f{OPENLCB_MESSAGE | (uint32_t)mti << 12 | src, len, {}};
+    for (int i = 0; i < len; i++) f.data[i] = data[i];
+    return f;
+}
+
+CanFrame addressed(uint16_t mti, uint16_t src, uint16_t dst, const uint8_t *data, uint8_t len) {
+    CanFrame f{OPENLCB_MESSAGE | (uint32_t)mti << 12 | src, (uint8_t)(len + 2), {}};
+    f.data[0] = dst >> 8;
+    f.data[1] = dst & 0xFF;
+    for (int i = 0; i < len; i++) f.data[2 + i] = data[i];
+    return f;
+}
+
+CanFrame event_report(uint16_t src, uint64_t event) {
+    CanFrame f{OPENLCB_MESSAGE | (uint32_t)MTI_EVENT_REPORT << 12 | src, 8, {}};
+    put_u64(f.data, event);
+    return f;
+}
+
+void put_u48(uint8_t *dst, uint64_t v) {
+    for (int i = 0; i < 6; i++) dst[i] = v >> (40 - 8 * i);
+}
+
+uint64_t get_u48(const uint8_t *src) {
+    uint64_t v = 0;
+    for (int i = 0; i < 6; i++) v = v << 8 | src[i];
+    return v;
+}
+
+void put_u64(uint8_t *dst, uint64_t v) {
+    for (int i = 0; i < 8; i++) dst[i] = v >> (56 - 8 * i);
+}
+
+uint64_t get_u64(const uint8_t *src) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = v << 8 | src[i];
+    return v;
+}
+
+} // namespace lcc
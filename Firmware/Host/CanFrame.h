@@ -0,0 +1,82 @@
+#ifndef __CANFRAME_H
+#define __CANFRAME_H
+
+#include <stdint.h>
+#include <string>
+
+/// One extended CAN frame as carried by OpenLCB
+struct CanFrame {
+    uint32_t id;        // 29-bit extended identifier
+    uint8_t len;        // Data length (0-8)
+    uint8_t data[8];
+};
+
+/// Bits one extended data frame occupies on the wire, including stuff bits
+/// (computed exactly over SOF through CRC), the trailer and the 3 bit
+/// interframe space
+unsigned can_frame_bits(const CanFrame &frame);
+
+/// Format a frame as a GridConnect line, ":X<id>N<data>;"
+std::string gc_format(const CanFrame &frame);
+
+/// Parse a GridConnect line (without the trailing newline). Returns false
+/// for anything that is not an extended data frame.
+bool gc_parse(const std::string &line, CanFrame *frame);
+
+/// OpenLCB CAN header fields and frame builders
+namespace lcc {
+
+constexpr uint32_t OPENLCB_MESSAGE = 0x19000000;  // Global or addressed message
+constexpr uint32_t DATAGRAM_ONLY = 0x1A000000;
+constexpr uint32_t DATAGRAM_FIRST = 0x1B000000;
+constexpr uint32_t DATAGRAM_MIDDLE = 0x1C000000;
+constexpr uint32_t DATAGRAM_FINAL = 0x1D000000;
+
+constexpr uint16_t MTI_INITIALIZATION_COMPLETE = 0x100;
+constexpr uint16_t MTI_VERIFY_NODE_ID_ADDRESSED = 0x488;
+constexpr uint16_t MTI_VERIFY_NODE_ID_GLOBAL = 0x490;
+constexpr uint16_t MTI_VERIFIED_NODE_ID = 0x170;
+constexpr uint16_t MTI_VERIFIED_NODE_ID_SIMPLE = 0x171;
+constexpr uint16_t MTI_EVENT_REPORT = 0x5B4;
+constexpr uint16_t MTI_CONSUMER_IDENTIFIED_RANGE = 0x4A4;
+constexpr uint16_t MTI_EVENTS_IDENTIFY_GLOBAL = 0x970;
+constexpr uint16_t MTI_DATAGRAM_OK = 0xA28;
+constexpr uint16_t MTI_DATAGRAM_REJECTED = 0xA48;
+
+/// Largest datagram payload
+constexpr size_t DATAGRAM_MAX = 72;
+
+/// Check ID frame n (7 down to 4) carrying 12 bits of the node ID
+inline CanFrame cid(int n, uint64_t nodeId, uint16_t alias) {
+    uint32_t chunk = (nodeId >> (12 * (n - 4))) & 0xFFF;
+    return CanFrame{(uint32_t)(0x10 | n) << 24 | chunk << 12 | alias, 0, {}};
+}
+
+/// Reserve ID, Alias Map Definition and Alias Map Enquiry control frames
+CanFrame rid(uint16_t alias);
+CanFrame amd(uint16_t alias, uint64_t nodeId);
+
+/// Control frame type (0x700 RID, 0x701 AMD, 0x702 AME, ...) or 0 for a
+/// message frame. Check ID frames return 0x1000 | n.
+uint16_t control_type(const CanFrame &frame);
+
+/// Global or addressed message frame (addressed MTIs get the destination
+/// alias in the first two data bytes)
+CanFrame message(uint16_t mti, uint16_t src, const uint8_t *data, uint8_t len);
+CanFrame addressed(uint16_t mti, uint16_t src, uint16_t dst, const uint8_t *data, uint8_t len);
+
+/// Event report for a full 64-bit event ID
+CanFrame event_report(uint16_t src, uint64_t event);
+
+inline uint16_t src_alias(const CanFrame &frame) { return frame.id & 0xFFF; }
+inline uint16_t mti(const CanFrame &frame) { return (frame.id >> 12) & 0xFFF; }
+
+/// Big-endian helpers for node and event IDs
+void put_u48(uint8_t *dst, uint64_t v);
+uint64_t get_u48(const uint8_t *src);
+void put_u64(uint8_t *dst, uint64_t v);
+uint64_t get_u64(const uint8_t *src);
+
+} // namespace lcc
+
+#endif // __CANFRAME_H
@@ -0,0 +1,263 @@
+#include "HostNode.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace lcc;
+
+uint64_t host_millis() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+uint32_t crc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+HostNode::HostNode(uint64_t nodeId)
+    : fd_(-1), nodeId_(nodeId), seed_(nodeId), alias_(0), reserved_(false), conflict_(false),
+      frames_(0), busBits_(0) {
+}
+
+HostNode::~HostNode() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool HostNode::connect(const char *host, int port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *res;
+    char portStr[8];
+    snprintf(portStr, sizeof(portStr), "%d", port);
+    if (getaddrinfo(host, portStr, &hints, &res) != 0) return false;
+    for (addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd_ = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd_ < 0) continue;
+        if (::connect(fd_, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(fd_);
+        fd_ = -1;
+    }
+    freeaddrinfo(res);
+    if (fd_ < 0) return false;
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+uint16_t HostNode::next_alias() {
+    // Any non-zero 12-bit value will do; different node IDs give different
+    // sequences
+    uint16_t alias;
+    do {
+        seed_ = seed_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        alias = (seed_ >> 40) & 0xFFF;
+    } while (alias == 0);
+    return alias;
+}
+
+bool HostNode::start() {
+    frames_ = 0;
+    busBits_ = 0;
+    for (int attempt = 0; attempt < 8; attempt++) {
+        alias_ = next_alias();
+        reserved_ = false;
+        conflict_ = false;
+        for (int n = 7; n >= 4; n--) send_frame(cid(n, nodeId_, alias_));
+
+        // Anyone already using the alias objects within 200 ms
+        uint64_t until = host_millis() + 200;
+        Message msg;
+        while (!conflict_ && !closed()) {
+            int64_t left = (int64_t)(until - host_millis());
+            if (left <= 0) break;
+            receive(&msg, left);
+        }
+        if (closed()) return false;
+        if (conflict_) continue;
+
+        send_frame(rid(alias_));
+        send_frame(amd(alias_, nodeId_));
+        reserved_ = true;
+        uint8_t id[6];
+        put_u48(id, nodeId_);
+        send_global(MTI_INITIALIZATION_COMPLETE, id, 6);
+        return true;
+    }
+    return false;
+}
+
+bool HostNode::send_frame(const CanFrame &frame) {
+    if (fd_ < 0) return false;
+    std::string line = gc_format(frame) + "\n";
+    if (write(fd_, line.data(), line.size()) != (ssize_t)line.size()) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    frames_++;
+    busBits_ += can_frame_bits(frame);
+    return true;
+}
+
+bool HostNode::read_frame(CanFrame *frame, int timeoutMs) {
+    uint64_t until = host_millis() + timeoutMs;
+    while (fd_ >= 0) {
+        size_t end = rx_.find(';');
+        if (end != std::string::npos) {
+            std::string line = rx_.substr(0, end + 1);
+            rx_.erase(0, end + 1);
+            if (gc_parse(line, frame)) {
+                frames_++;
+                busBits_ += can_frame_bits(*frame);
+                return true;
+            }
+            continue;
+        }
+        int64_t left = (int64_t)(until - host_millis());
+        if (left < 0) return false;
+        pollfd p = {fd_, POLLIN, 0};
+        if (poll(&p, 1, left) <= 0) return false;
+        char buf[4096];
+        ssize_t got = read(fd_, buf, sizeof(buf));
+        if (got <= 0) {
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        rx_.append(buf, got);
+    }
+    return false;
+}
+
+bool HostNode::receive(Message *msg, int timeoutMs) {
+    uint64_t until = host_millis() + timeoutMs;
+    CanFrame frame;
+    for (;;) {
+        int64_t left = (int64_t)(until - host_millis());
+        if (!read_frame(&frame, left > 0 ? left : 0)) return false;
+        if (handle_frame(frame, msg)) return true;
+    }
+}
+
+bool HostNode::handle_frame(const CanFrame &frame, Message *msg) {
+    uint16_t src = src_alias(frame);
+    if (!(frame.id & 0x08000000)) {
+        // CAN control frame (alias allocation)
+        uint16_t control = control_type(frame);
+        if (control == 0x702 && reserved_ &&
+            (frame.len < 6 || get_u48(frame.data) == nodeId_)) {
+            send_frame(amd(alias_, nodeId_));
+        } else if (src == alias_ && control >= 0x1000 && reserved_) {
+            // Someone checking our alias: it is taken
+            send_frame(rid(alias_));
+        } else if (src == alias_) {
+            conflict_ = true;
+        }
+        return false;
+    }
+    if (src == alias_) {
+        conflict_ = true;
+        return false;
+    }
+    if (!reserved_) return false;
+
+    uint32_t type = frame.id & 0x0F000000;
+    if (type != (OPENLCB_MESSAGE & 0x0F000000)) {
+        // Datagram frame addressed to an alias in the header
+        if (((frame.id >> 12) & 0xFFF) != alias_) return false;
+        std::vector<uint8_t> &buf = partial_[src];
+        if (type == (DATAGRAM_ONLY & 0x0F000000) || type == (DATAGRAM_FIRST & 0x0F000000)) {
+            buf.clear();
+        }
+        buf.insert(buf.end(), frame.data, frame.data + frame.len);
+        if (type == (DATAGRAM_ONLY & 0x0F000000) || type == (DATAGRAM_FINAL & 0x0F000000)) {
+            msg->mti = 0;
+            msg->src = src;
+            msg->data.swap(buf);
+            partial_.erase(src);
+            return true;
+        }
+        return false;
+    }
+
+    uint16_t m = mti(frame);
+    const uint8_t *data = frame.data;
+    uint8_t len = frame.len;
+    if (m & 0x008) {
+        // Addressed: first two bytes carry the destination alias
+        if (len < 2 || (((data[0] & 0x0F) << 8) | data[1]) != alias_) return false;
+        data += 2;
+        len -= 2;
+    }
+
+    if (m == MTI_VERIFY_NODE_ID_GLOBAL || m == MTI_VERIFY_NODE_ID_ADDRESSED) {
+        if (len < 6 || get_u48(data) == nodeId_) {
+            uint8_t id[6];
+            put_u48(id, nodeId_);
+            send_global(MTI_VERIFIED_NODE_ID, id, 6);
+        }
+        if (m == MTI_VERIFY_NODE_ID_ADDRESSED) return false;
+    }
+    msg->mti = m;
+    msg->src = src;
+    msg->data.assign(data, data + len);
+    return true;
+}
+
+uint16_t HostNode::find_alias(uint64_t nodeId, int timeoutMs) {
+    uint8_t id[6];
+    put_u48(id, nodeId);
+    send_global(MTI_VERIFY_NODE_ID_GLOBAL, id, 6);
+    uint64_t until = host_millis() + timeoutMs;
+    Message msg;
+    for (;;) {
+        int64_t left = (int64_t)(until - host_millis());
+        if (left <= 0 || !receive(&msg, left)) return 0;
+        if ((msg.mti == MTI_VERIFIED_NODE_ID || msg.mti == MTI_VERIFIED_NODE_ID_SIMPLE) &&
+            msg.data.size() >= 6 && get_u48(msg.data.data()) == nodeId) {
+            return msg.src;
+        }
+    }
+}
+
+void HostNode::send_global(uint16_t mti, const uint8_t *data, uint8_t len) {
+    send_frame(message(mti, alias_, data, len));
+}
+
+void HostNode::send_addressed(uint16_t mti, uint16_t dst, const uint8_t *data, uint8_t len) {
+    send_frame(addressed(mti, alias_, dst, data, len));
+}
+
+void HostNode::send_datagram(uint16_t dst, const uint8_t *data, size_t len) {
+    for (size_t off = 0; off < len || off == 0; off += 8) {
+        uint32_t type;
+        bool first = off == 0;
+        bool last = off + 8 >= len;
+        if (first && last) type = DATAGRAM_ONLY;
+        else if (first) type = DATAGRAM_FIRST;
+        else if (last) type = DATAGRAM_FINAL;
+        else type = DATAGRAM_MIDDLE;
+        CanFrame f{type | (uint32_t)dst << 12 | alias_, (uint8_t)(last ? len - off : 8), {}};
+        memcpy(f.data, data + off, f.len);
+        send_frame(f);
+        if (last) break;
+    }
+}
+
+void HostNode::send_event(uint64_t event) {
+    send_frame(event_report(alias_, event));
+}
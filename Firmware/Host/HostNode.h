@@ -0,0 +1,81 @@
+#ifndef __HOSTNODE_H
+#define __HOSTNODE_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "CanFrame.h"
+
+/// Minimal OpenLCB node on a GridConnect TCP connection (an OpenMRN hub,
+/// JMRI, or gc_hub). Allocates an alias, answers alias and Verify Node ID
+/// traffic on its own, and hands global messages, messages addressed to it
+/// and reassembled datagrams to the caller.
+class HostNode {
+public:
+    struct Message {
+        uint16_t mti;           // MTI, or 0 for a datagram
+        uint16_t src;           // Source alias
+        std::vector<uint8_t> data;  // Payload (without the destination alias)
+    };
+
+    HostNode(uint64_t nodeId);
+    ~HostNode();
+
+    /// Connect to a GridConnect TCP hub
+    bool connect(const char *host, int port);
+
+    /// Reserve an alias and announce the node (Initialization Complete)
+    bool start();
+
+    /// Wait up to timeoutMs for the next message for the caller. Returns
+    /// false on timeout or when the connection closed.
+    bool receive(Message *msg, int timeoutMs);
+
+    /// Find the alias of another node with Verify Node ID (0 = not found)
+    uint16_t find_alias(uint64_t nodeId, int timeoutMs);
+
+    void send_global(uint16_t mti, const uint8_t *data, uint8_t len);
+    void send_addressed(uint16_t mti, uint16_t dst, const uint8_t *data, uint8_t len);
+    void send_datagram(uint16_t dst, const uint8_t *data, size_t len);
+    void send_event(uint64_t event);
+
+    uint16_t alias() { return alias_; }
+    uint64_t node_id() { return nodeId_; }
+    bool closed() { return fd_ < 0; }
+
+    /// Traffic seen through the hub since start(): every frame sent or
+    /// received, and the bits they would take on a CAN segment
+    unsigned frames() { return frames_; }
+    uint64_t bus_bits() { return busBits_; }
+
+private:
+    bool send_frame(const CanFrame &frame);
+    bool read_frame(CanFrame *frame, int timeoutMs);
+
+    /// Handle one frame; returns true if it completed a message for the caller
+    bool handle_frame(const CanFrame &frame, Message *msg);
+
+    /// Next candidate alias (pseudo-random, seeded from the node ID)
+    uint16_t next_alias();
+
+    int fd_;
+    std::string rx_;
+    uint64_t nodeId_;
+    uint64_t seed_;
+    uint16_t alias_;
+    bool reserved_;
+    bool conflict_;
+    std::map<uint16_t, std::vector<uint8_t>> partial_;  // Datagrams by source alias
+    unsigned frames_;
+    uint64_t busBits_;
+};
+
+/// Milliseconds on a monotonic clock
+uint64_t host_millis();
+
+/// CRC-32 (as used by zlib), to compare frames between tools
+uint32_t crc32(const uint8_t *data, size_t len);
+
+#endif // __HOSTNODE_H
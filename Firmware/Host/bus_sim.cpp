@@ -0,0 +1,616 @@
+// Multi-node CAN segment simulation for sizing large layouts.
+//
+// Simulates one 125 kbit/s CAN segment with many lighting boards and a
+// configuration tool (JMRI) on it. Every frame takes its exact bit time
+// (stuff bits included) and competes in CAN arbitration with the queued
+// frames of the other nodes. Each board runs an in-order executor with the
+// same latency model as skew_sim and its own drifting clock. Every board
+// runs the firmware's SceneEngine and ChannelTable (the event ranges it
+// identifies and how it resolves incoming events), and Controllers decide
+// what to send with the firmware's SceneBroadcaster, polled every 10 ms like
+// the panel, looping their own events back as the board does.
+//
+// For each node count it runs, on one timeline:
+//   - power-up: alias allocation (CID, 200 ms wait, RID, AMD), Initialization
+//     Complete and the consumer identification every node sends after it,
+//     with alias conflicts resolved as the standard requires, then every
+//     Controller's startup fade-in
+//   - steady state: every Controller's timebase and periodic sync
+//   - a scene change (colours + Synchronized Duration) on a quiet bus
+//   - a global Identify Events from the tool, with a scene change issued
+//     right behind it
+//   - one Controller streaming a slider
+// and reports bus utilization, the identify storm length, how long the
+// Followers take to converge on the new scene and how far each board,
+// Controller included, starts the fade from the instant the Controller chose.
+//
+// Usage: bus_sim [--nodes N,N,...] [--controllers C] [--seed S]
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "CanFrame.h"
+#include "ChannelTable.h"
+#include "SceneBroadcaster.h"
+#include "SceneEngine.h"
+
+using namespace lcc;
+using openlcb::SceneBroadcaster;
+using openlcb::SceneEngine;
+using openlcb::SceneValues;
+
+namespace {
+
+constexpr double BIT_US = 8;                     // 125 kbit/s
+constexpr int64_t CID_WAIT_US = 200000;          // Alias reservation wait
+constexpr int64_t DRIVER_US = 100;               // Executor to TX queue
+constexpr int64_t SERVICE_US = 60;               // Executor time per received frame
+constexpr int64_t POLL_US = 10000;               // Controller panel poll (loop())
+constexpr uint16_t SYNC_INTERVAL_S = 3;          // Controller periodic sync (default)
+constexpr uint16_t STREAM_INTERVAL_MS = 100;     // Streaming Interval (default)
+constexpr int64_t STARTUP_DELAY_US = 5000000;    // Controller startup animation delay
+constexpr uint8_t FADE_IN_S = 5;                 // Startup fade-in
+constexpr uint8_t SCENE_FADE_S = 5;
+/// Every board, Controller included, must start a synchronized fade within
+/// this of the instant the Controller chose, on a quiet bus and with the
+/// trigger held up behind an identify storm
+constexpr double ERROR_LIMIT_MS = 3.0;
+
+/// Default channel Event IDs (config.h RGBW_EVENT_INIT). Zone z of a
+/// multi-controller layout adds z to byte 4.
+constexpr uint64_t DEFAULT_EVENTS[openlcb::NUM_CHANNELS] = {
+    0x050101019F600000ULL, 0x050101019F600100ULL, 0x050101019F600200ULL,
+    0x050101019F600300ULL, 0x050101019F600400ULL, 0x050101019F600500ULL,
+    0x050101019F630000ULL, 0x050101019F610000ULL, 0x050101019F620000ULL,
+    0x050101019F600700ULL, 0x050101019F600600ULL,
+};
+
+std::mt19937 rng;
+
+double uniform(double lo, double hi) {
+    return std::uniform_real_distribution<double>(lo, hi)(rng);
+}
+
+/// Time from the end of a frame until a board's executor handles it (as
+/// skew_sim): interrupt and queueing, plus an occasional stall
+int64_t executor_latency_us() {
+    double us = 150 + std::exponential_distribution<double>(1.0 / 600)(rng);
+    if (uniform(0, 1) < 0.05) us += uniform(2000, 30000);
+    return (int64_t)us;
+}
+
+uint64_t zone_event(int zone, int channel) {
+    return DEFAULT_EVENTS[channel] + ((uint64_t)zone << 24);
+}
+
+/// Alias generator of the OpenLCB CAN Frame Transfer standard, seeded from
+/// the node ID
+struct AliasGenerator {
+    uint32_t lfsr1, lfsr2;
+
+    void seed(uint64_t nodeId) {
+        lfsr1 = (nodeId >> 24) & 0xFFFFFF;
+        lfsr2 = nodeId & 0xFFFFFF;
+    }
+    uint16_t next() {
+        uint16_t alias;
+        do {
+            uint32_t temp1 = ((lfsr1 << 9) | ((lfsr2 >> 15) & 0x1FF)) & 0xFFFFFF;
+            uint32_t temp2 = (lfsr2 << 9) & 0xFFFFFF;
+            lfsr2 = lfsr2 + temp2 + 0x7A4BA9;
+            lfsr1 = lfsr1 + temp1 + 0x1B0CA3;
+            lfsr1 = (lfsr1 & 0xFFFFFF) + ((lfsr2 & 0xFF000000) >> 24);
+            lfsr2 &= 0xFFFFFF;
+            alias = (lfsr1 ^ lfsr2 ^ (lfsr1 >> 12) ^ (lfsr2 >> 12)) & 0xFFF;
+        } while (alias == 0);
+        return alias;
+    }
+};
+
+struct Queued {
+    CanFrame frame;
+    int64_t ready;      // Earliest time the controller may send it
+};
+
+class Simulation;
+
+struct Node : public SceneBroadcaster::Sink {
+    enum State { OFF, RESERVING, ACTIVE };
+
+    Node(Simulation *sim) : sim(sim), broadcaster(this) {}
+
+    /// SceneBroadcaster::Sink: queue the event and loop it back, as
+    /// RGBWStrip::send_channel_event() does
+    void send_channel_event(int channel, uint16_t value) override;
+
+    /// A channel event sent or received at real time us reaches the engine
+    void channel_event(int64_t us, int channel, uint16_t value);
+
+    int index;
+    uint64_t nodeId;
+    bool controller;
+    bool tool;
+    int zone;
+    State state = OFF;
+    AliasGenerator aliases;
+    uint16_t alias = 0;
+    unsigned generation = 0;         // Bumped on every new alias attempt
+    std::deque<Queued> txq;
+    bool sending = false;            // Head of txq is on the bus
+    int64_t lastHandled = 0;
+    double ppm;
+    double offsetUs;
+    Simulation *sim;
+    SceneEngine engine;
+    SceneBroadcaster broadcaster;    // Controller
+    openlcb::ChannelTable<Node, openlcb::NUM_CHANNELS> channels;
+    unsigned retries = 0;
+    // Latest synchronized fade for the convergence measurement
+    int64_t triggerUs = -1;          // Real time the trigger was handled
+    int64_t fadeStartUs = -1;        // Real time the fade starts
+    SceneValues fadeTarget{};
+    // Controller: real time it meant its latest synchronized fade to start
+    int64_t intendedUs = -1;
+
+    /// micros() on this board at real time us
+    unsigned long local_us(int64_t us) {
+        return (unsigned long)(us * (1 + ppm * 1e-6) + offsetUs);
+    }
+    int64_t real_us(unsigned long localUs) {
+        // Inverse of local_us
+        double us = ((double)localUs - offsetUs) / (1 + ppm * 1e-6);
+        return (int64_t)us;
+    }
+};
+
+struct Storm {
+    unsigned frames = 0;
+    int64_t lastEndUs = 0;
+};
+
+class Simulation {
+public:
+    Simulation(int boards, int controllers);
+
+    /// Run all phases; returns false if the network misbehaved
+    bool run();
+
+    /// Queue a channel event report from n
+    void send_event(Node &n, int channel, uint16_t value);
+
+    int64_t now() const { return now_; }
+
+private:
+    using Action = std::function<void()>;
+    struct Event {
+        int64_t t;
+        uint64_t seq;
+        Action action;
+        bool operator>(const Event &o) const { return t != o.t ? t > o.t : seq > o.seq; }
+    };
+
+    void at(int64_t t, Action action) { events_.push({t, seq_++, std::move(action)}); }
+    void run_until(int64_t t);
+
+    void send(Node &n, const CanFrame &frame, int64_t ready);
+    void arbitrate();
+    void transmit_done(Node &n);
+
+    void boot(Node &n);
+    void start_reservation(Node &n);
+    void finish_reservation(Node &n, unsigned generation);
+    void handle(Node &n, const CanFrame &frame);
+    void identify(Node &n);
+
+    void controller_poll(Node &n);
+    SceneValues scene_change(Node &n);
+
+    struct Convergence {
+        double latestMs;    // Scene change to the last Follower fading
+        double errorMs;     // Largest distance of a fade start from the intended one
+        bool ok;            // Every board fades to the new scene
+    };
+    Convergence convergence(int zone, int64_t issuedUs, const SceneValues &scene);
+
+    std::deque<Node> nodes_;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    uint64_t seq_ = 0;
+    int64_t now_ = 0;
+    int64_t busyUntil_ = 0;
+    bool arbitrationPending_ = false;
+    double busyUs_ = 0;
+    unsigned frames_ = 0;
+    unsigned collisions_ = 0;
+    int64_t lastInitUs_ = 0;
+    Storm storm_;
+    bool streaming_ = false;
+
+public:
+    // Results
+    int boards;
+    int controllers;
+    double startupS = 0;
+    unsigned startupFrames = 0;
+    unsigned aliasRetries = 0;
+    double steadyLoad = 0;
+    double streamLoad = 0;
+    unsigned identifyFrames = 0;
+    double identifyS = 0;
+    Convergence quiet{};
+    Convergence inStorm{};
+};
+
+Simulation::Simulation(int boards, int controllers) : boards(boards), controllers(controllers) {
+    for (int i = 0; i <= boards; i++) {
+        nodes_.emplace_back(this);
+        Node &n = nodes_.back();
+        n.index = i;
+        n.tool = i == boards;
+        n.controller = !n.tool && i < controllers;
+        n.zone = n.tool ? -1 : (n.controller ? i : i % controllers);
+        n.nodeId = n.tool ? 0x0201120100FEULL : 0x050101019F00ULL + i;
+        n.ppm = uniform(-40, 40);
+        n.offsetUs = uniform(0, 60e9);
+        n.aliases.seed(n.nodeId);
+        n.engine.set_timebase_source(n.controller);
+        n.broadcaster.configure(SYNC_INTERVAL_S, STREAM_INTERVAL_MS);
+        if (n.tool) continue;
+        // The channels RGBWStrip::apply_configuration() routes
+        for (int c = 0; c < openlcb::NUM_CHANNELS; c++) {
+            if (openlcb::channel_consumed(n.controller, c)) n.channels.add_channel(&n, c, zone_event(n.zone, c));
+        }
+        n.channels.update_ranges();
+    }
+}
+
+void Simulation::run_until(int64_t t) {
+    while (!events_.empty() && events_.top().t <= t) {
+        Event e = events_.top();
+        events_.pop();
+        now_ = e.t;
+        e.action();
+    }
+    now_ = t;
+}
+
+void Simulation::send(Node &n, const CanFrame &frame, int64_t ready) {
+    n.txq.push_back({frame, ready});
+    at(std::max(ready, busyUntil_), [this] { arbitrate(); });
+}
+
+void Simulation::arbitrate() {
+    if (now_ < busyUntil_) return;
+    // Every node with a frame ready contends; the lowest identifier wins
+    Node *winner = nullptr;
+    for (Node &n : nodes_) {
+        if (n.txq.empty() || n.txq.front().ready > now_) continue;
+        if (!winner || n.txq.front().frame.id < winner->txq.front().frame.id) winner = &n;
+    }
+    if (!winner) return;
+    const CanFrame &frame = winner->txq.front().frame;
+    double us = can_frame_bits(frame) * BIT_US;
+    winner->sending = true;
+    busyUntil_ = now_ + (int64_t)us;
+    busyUs_ += us;
+    Node *sender = winner;
+    at(busyUntil_, [this, sender] { transmit_done(*sender); });
+}
+
+void Simulation::transmit_done(Node &n) {
+    CanFrame frame = n.txq.front().frame;
+    n.txq.pop_front();
+    n.sending = false;
+    frames_++;
+
+    // Every other running node receives the frame at the same moment and
+    // handles it after its own executor latency, in order
+    for (Node &o : nodes_) {
+        if (&o == &n || o.state == Node::OFF) continue;
+        int64_t t = std::max(now_ + executor_latency_us(), o.lastHandled + SERVICE_US);
+        o.lastHandled = t;
+        Node *receiver = &o;
+        at(t, [this, receiver, frame] { handle(*receiver, frame); });
+    }
+
+    uint16_t control = control_type(frame);
+    if (control == 0x1004 && n.state == Node::RESERVING && src_alias(frame) == n.alias) {
+        // Last Check ID sent: anyone using the alias has 200 ms to object
+        unsigned generation = n.generation;
+        Node *node = &n;
+        at(now_ + CID_WAIT_US, [this, node, generation] { finish_reservation(*node, generation); });
+    } else if (control == 0 && mti(frame) == MTI_INITIALIZATION_COMPLETE) {
+        lastInitUs_ = now_;
+    } else if (control == 0 && mti(frame) == MTI_CONSUMER_IDENTIFIED_RANGE) {
+        storm_.frames++;
+        storm_.lastEndUs = now_;
+    }
+    at(now_, [this] { arbitrate(); });
+}
+
+void Simulation::boot(Node &n) {
+    n.state = Node::RESERVING;
+    n.lastHandled = now_;
+    start_reservation(n);
+}
+
+void Simulation::start_reservation(Node &n) {
+    // Drop Check ID frames of the abandoned alias that are not on the bus yet
+    for (size_t i = n.sending ? 1 : 0; i < n.txq.size();) {
+        if (control_type(n.txq[i].frame) & 0x1000) {
+            n.txq.erase(n.txq.begin() + i);
+        } else {
+            i++;
+        }
+    }
+    n.alias = n.aliases.next();
+    n.generation++;
+    for (int c = 7; c >= 4; c--) send(n, cid(c, n.nodeId, n.alias), now_ + DRIVER_US);
+}
+
+void Simulation::finish_reservation(Node &n, unsigned generation) {
+    if (n.state != Node::RESERVING || n.generation != generation) return;
+    n.state = Node::ACTIVE;
+    int64_t t = now_ + DRIVER_US;
+    send(n, rid(n.alias), t);
+    send(n, amd(n.alias, n.nodeId), t);
+    uint8_t id[6];
+    put_u48(id, n.nodeId);
+    send(n, message(MTI_INITIALIZATION_COMPLETE, n.alias, id, 6), t);
+    identify(n);
+
+    if (n.controller) {
+        Node *node = &n;
+        at(now_ + STARTUP_DELAY_US, [this, node] {
+            // Startup animation: a burst of timebase samples and the fade-in,
+            // then the regular broadcast and periodic sync
+            const uint8_t values[SceneBroadcaster::SCENE_CHANNELS] = {200, 120, 40, 0, 255};
+            node->broadcaster.start_fade_in(values, FADE_IN_S);
+            controller_poll(*node);
+        });
+    }
+}
+
+void Simulation::identify(Node &n) {
+    // RGBWEventDispatcher::handle_identify_global(): one frame per range
+    for (unsigned i = 0; i < n.channels.num_ranges(); i++) {
+        uint8_t data[8];
+        put_u64(data, n.channels.identifier(i));
+        send(n, message(MTI_CONSUMER_IDENTIFIED_RANGE, n.alias, data, 8), now_ + DRIVER_US);
+    }
+}
+
+void Simulation::handle(Node &n, const CanFrame &frame) {
+    uint16_t control = control_type(frame);
+    uint16_t src = src_alias(frame);
+
+    if (n.state == Node::RESERVING) {
+        // Any frame from our candidate alias means someone else has it or
+        // wants it: pick the next one
+        if (src == n.alias) {
+            n.retries++;
+            start_reservation(n);
+        }
+        return;
+    }
+    if (n.state != Node::ACTIVE) return;
+
+    if (src == n.alias) {
+        if (control & 0x1000) {
+            // Someone is checking our alias: object
+            send(n, rid(n.alias), now_ + DRIVER_US);
+        } else {
+            collisions_++;
+        }
+        return;
+    }
+    if (control != 0) return;
+
+    if (mti(frame) == MTI_EVENTS_IDENTIFY_GLOBAL) {
+        identify(n);
+    } else if (mti(frame) == MTI_EVENT_REPORT && !n.tool) {
+        // The registry matches the event to one of our ranges, and
+        // RGBWEventDispatcher resolves it to a channel
+        uint64_t event = get_u64(frame.data);
+        for (unsigned i = 0; i < n.channels.num_ranges(); i++) {
+            const auto &range = n.channels.range(i);
+            if ((event >> range.bits) != (range.base >> range.bits)) continue;
+            const auto *target = n.channels.resolve(i, event);
+            if (!target) break;
+            int c = target->channel;
+            uint16_t value = event & openlcb::channel_value_mask(c);
+            n.channel_event(now_, c, value);
+            // RGBWStrip::receive_event(): the Controller relays Duration
+            if (n.controller && c == 5) n.broadcaster.relay_duration(n.local_us(now_), value);
+            break;
+        }
+    }
+}
+
+void Node::send_channel_event(int channel, uint16_t value) {
+    sim->send_event(*this, channel, value);
+    if (channel == 8) intendedUs = sim->now() + SceneEngine::FADE_START_LEAD_MS * 1000;
+    channel_event(sim->now(), channel, value);
+}
+
+void Node::channel_event(int64_t us, int channel, uint16_t value) {
+    engine.channel_event(local_us(us), channel, value);
+    if (channel == 8) {
+        triggerUs = us;
+        fadeStartUs = real_us(engine.fade_start_time());
+        fadeTarget = engine.scheduled() ? engine.pending() : engine.fade_target();
+    }
+}
+
+void Simulation::send_event(Node &n, int channel, uint16_t value) {
+    uint64_t event = (zone_event(n.zone, channel) & ~openlcb::channel_value_mask(channel)) | value;
+    send(n, event_report(n.alias, event), now_ + DRIVER_US);
+}
+
+void Simulation::controller_poll(Node &n) {
+    unsigned long local = n.local_us(now_);
+    n.broadcaster.poll(local / 1000, local);
+    Node *node = &n;
+    at(now_ + POLL_US, [this, node] { controller_poll(*node); });
+}
+
+SceneValues Simulation::scene_change(Node &n) {
+    // New panel values and a Duration input, sent at the next poll
+    uint8_t v[SceneBroadcaster::SCENE_CHANNELS];
+    for (int c = 0; c < SceneBroadcaster::SCENE_CHANNELS; c++) {
+        v[c] = std::uniform_int_distribution<int>(0, 255)(rng);
+        n.broadcaster.set_input(c, v[c]);
+    }
+    n.broadcaster.request_duration(SCENE_FADE_S);
+    for (Node &f : nodes_) f.triggerUs = -1;
+    return SceneValues{v[0], v[1], v[2], v[3], v[4]};
+}
+
+Simulation::Convergence Simulation::convergence(int zone, int64_t issuedUs,
+                                                const SceneValues &scene) {
+    Convergence c{0, 0, true};
+    int64_t intended = -1;
+    for (Node &n : nodes_) {
+        if (n.controller && n.zone == zone) intended = n.intendedUs;
+    }
+    for (Node &n : nodes_) {
+        if (n.tool || n.zone != zone) continue;
+        if (n.triggerUs < 0 || n.fadeTarget != scene || intended < 0) {
+            c.ok = false;
+            continue;
+        }
+        // Fading from the later of its start time and handling the trigger
+        int64_t fading = std::max(n.fadeStartUs, n.triggerUs);
+        c.latestMs = std::max(c.latestMs, (fading - issuedUs) / 1000.0);
+        c.errorMs = std::max(c.errorMs, std::abs(n.fadeStartUs - intended) / 1000.0);
+    }
+    return c;
+}
+
+bool Simulation::run() {
+    // Power-up: every board boots within half a second; the tool is already
+    // on the bus with its alias
+    Node &tool = nodes_.back();
+    tool.state = Node::ACTIVE;
+    tool.alias = tool.aliases.next();
+    for (Node &n : nodes_) {
+        if (n.tool) continue;
+        Node *node = &n;
+        at((int64_t)uniform(300000, 800000), [this, node] { boot(*node); });
+    }
+    run_until(20000000);
+    for (Node &n : nodes_) {
+        if (n.state != Node::ACTIVE) return false;
+        aliasRetries += n.retries;
+    }
+    startupS = storm_.lastEndUs / 1e6;
+    startupFrames = frames_;
+
+    // Steady state, after the timebase has settled
+    int64_t t0 = 25000000;
+    run_until(t0);
+    double busy0 = busyUs_;
+    run_until(t0 + 30000000);
+    steadyLoad = (busyUs_ - busy0) / 30000000;
+
+    // Scene change on a quiet bus, away from the periodic sync
+    Node &ctrl = nodes_[0];
+    int64_t tQuiet = now_ + 1500000;
+    run_until(tQuiet);
+    SceneValues scene = scene_change(ctrl);
+    run_until(tQuiet + 2000000);
+    quiet = convergence(0, tQuiet, scene);
+    run_until(tQuiet + 8000000);
+
+    // The tool refreshes: global Identify Events, with a scene change issued
+    // just behind it
+    int64_t tStorm = now_;
+    storm_ = Storm();
+    send(tool, message(MTI_EVENTS_IDENTIFY_GLOBAL, tool.alias, nullptr, 0), tStorm);
+    at(tStorm + 2000, [this, &ctrl, &scene] { scene = scene_change(ctrl); });
+    run_until(tStorm + 10000000);
+    identifyFrames = storm_.frames;
+    identifyS = (storm_.lastEndUs - tStorm) / 1e6;
+    inStorm = convergence(0, tStorm + 2000, scene);
+
+    // One Controller streams a slider: three channels change per interval
+    int64_t tStream = now_;
+    busy0 = busyUs_;
+    const int64_t streamUs = STREAM_INTERVAL_MS * 1000;
+    std::function<void()> stream = [this, &ctrl, &stream, tStream, streamUs] {
+        if (now_ >= tStream + 30000000) return;
+        for (int c = 0; c < 3; c++) ctrl.broadcaster.set_input(c, (uint8_t)(now_ / streamUs + c));
+        at(now_ + streamUs, stream);
+    };
+    at(tStream, stream);
+    run_until(tStream + 30000000);
+    streamLoad = (busyUs_ - busy0) / 30000000;
+
+    return collisions_ == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<int> counts = {15, 50, 100, 150, 200};
+    int controllers = 1;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--nodes")) {
+            counts.clear();
+            for (char *p = argv[i + 1]; *p;) {
+                counts.push_back(strtol(p, &p, 10));
+                if (*p == ',') p++;
+            }
+        } else if (!strcmp(argv[i], "--controllers")) {
+            controllers = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "--seed")) {
+            seed = atoi(argv[i + 1]);
+        }
+    }
+
+    printf("CAN segment at 125 kbit/s, %d controller(s), rest followers, plus one tool node\n\n",
+           controllers);
+    printf("%6s %9s %8s %7s %8s %9s %9s %10s %10s %9s %9s %9s\n", "Nodes", "Startup", "Startup",
+           "Alias", "Steady", "Stream", "Identify", "Identify", "Quiet", "Storm", "Quiet", "Storm");
+    printf("%6s %9s %8s %7s %8s %9s %9s %10s %10s %9s %9s %9s\n", "", "s", "frames", "retries",
+           "load", "load", "frames", "storm s", "scene ms", "scene ms", "err ms", "err ms");
+
+    bool ok = true;
+    for (int boards : counts) {
+        rng.seed(seed);
+        Simulation sim(boards, controllers);
+        bool healthy = sim.run();
+        printf("%6d %9.2f %8u %7u %7.1f%% %8.1f%% %9u %10.2f %10.1f %9.1f %9.2f %9.2f\n", boards,
+               sim.startupS, sim.startupFrames, sim.aliasRetries, sim.steadyLoad * 100,
+               sim.streamLoad * 100, sim.identifyFrames, sim.identifyS, sim.quiet.latestMs,
+               sim.inStorm.latestMs, sim.quiet.errorMs, sim.inStorm.errorMs);
+        if (!healthy) {
+            printf("       FAIL: alias allocation did not complete cleanly\n");
+            ok = false;
+        }
+        if (!sim.quiet.ok || !sim.inStorm.ok) {
+            printf("       FAIL: some boards did not fade to the new scene\n");
+            ok = false;
+        }
+        if (sim.quiet.errorMs > ERROR_LIMIT_MS || sim.inStorm.errorMs > ERROR_LIMIT_MS) {
+            printf("       FAIL: fade start %.2f ms (quiet bus), %.2f ms (behind an identify)"
+                   " from the intended one, above %.1f ms\n", sim.quiet.errorMs, sim.inStorm.errorMs,
+                   ERROR_LIMIT_MS);
+            ok = false;
+        }
+    }
+    printf("\nStartup: power-up until the last identification frame. Load: bus busy time\n"
+           "with every controller's timebase and periodic sync, then with one controller\n"
+           "streaming three channels. Scene ms: from the scene change until the last\n"
+           "follower is fading, on a quiet bus and issued right behind a global Identify\n"
+           "Events. Err: largest distance of a board's fade start, controller included,\n"
+           "from the instant the controller chose.\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+// Event dispatch benchmark for the consumer range table.
+//
+// Builds the firmware's EventRangeTable for N channel targets laid out like
+// boards with the default Event IDs (one zone each) and measures the cost of
+// resolving an incoming event through its registered range, against the
+// linear scan of one handler per channel it replaced. Also checks, on that
+// layout and on random ones, that the registered ranges cover exactly the
+// claimed events: every event in a range belongs to a target, events nobody
+// claimed resolve to none, and no two ranges could be merged into one.
+// Fails if a check fails or the table cost grows with the number of targets.
+//
+// Usage: dispatch_bench [events] [seed]
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "EventRangeTable.h"
+#include "SceneEngine.h"
+
+using openlcb::EventRangeTable;
+
+namespace {
+
+/// Table cost at the largest N relative to the smallest
+constexpr double GROWTH_LIMIT = 4.0;
+constexpr int RANDOM_LAYOUTS = 2000;
+
+/// Default channel Event IDs (config.h RGBW_EVENT_INIT); board b adds b << 24
+constexpr uint64_t DEFAULT_EVENTS[openlcb::NUM_CHANNELS] = {
+    0x050101019F600000ULL, 0x050101019F600100ULL, 0x050101019F600200ULL,
+    0x050101019F600300ULL, 0x050101019F600400ULL, 0x050101019F600500ULL,
+    0x050101019F630000ULL, 0x050101019F610000ULL, 0x050101019F620000ULL,
+    0x050101019F600700ULL, 0x050101019F600600ULL,
+};
+
+std::mt19937_64 rng;
+
+struct Claim {
+    uint64_t eventId;
+    unsigned bits;
+};
+
+bool claims(const Claim &c, uint64_t event) {
+    return (event >> c.bits) == (c.eventId >> c.bits);
+}
+
+/// Index of the claim holding event, or -1 (one handler per channel)
+int linear_find(const std::vector<Claim> &claimed, uint64_t event) {
+    for (size_t i = 0; i < claimed.size(); i++) {
+        if (claims(claimed[i], event)) return i;
+    }
+    return -1;
+}
+
+/// Index of the range holding event, or -1 (as the event registry matches)
+template <unsigned N>
+int range_of(const EventRangeTable<N> &table, uint64_t event) {
+    for (unsigned i = 0; i < table.num_ranges(); i++) {
+        const auto &r = table.range(i);
+        if ((event >> r.bits) == (r.base >> r.bits)) return i;
+    }
+    return -1;
+}
+
+/// Checks the ranges of a table built from claimed. Returns the number of
+/// errors and prints the first one.
+template <unsigned N>
+int check(const EventRangeTable<N> &table, const std::vector<Claim> &claimed) {
+    int errors = 0;
+    auto fail = [&errors](const char *what, uint64_t event) {
+        if (!errors++) printf("  %s: 0x%016llX\n", what, (unsigned long long)event);
+    };
+
+    for (unsigned i = 0; i < table.num_ranges(); i++) {
+        const auto &r = table.range(i);
+        if (r.base & ((1ULL << r.bits) - 1)) fail("Unaligned range", r.base);
+        // Over-claim: every 256 event block of the range must have a target
+        for (uint64_t e = r.base; e < r.base + (1ULL << r.bits); e += 256) {
+            if (table.resolve(i, e) == table.NO_TARGET) fail("Range claims unused event", e);
+        }
+        // Aligned siblings of the same size would have been one range
+        for (unsigned j = 0; j < table.num_ranges(); j++) {
+            const auto &s = table.range(j);
+            if (j != i && s.bits == r.bits && r.bits < 16 &&
+                (s.base >> (r.bits + 1)) == (r.base >> (r.bits + 1))) {
+                fail("Mergeable ranges", r.base);
+            }
+        }
+    }
+    for (size_t c = 0; c < claimed.size(); c++) {
+        const Claim &cl = claimed[c];
+        uint64_t last = cl.eventId + (1ULL << cl.bits) - 1;
+        for (uint64_t e : {cl.eventId, last}) {
+            int i = range_of(table, e);
+            if (i < 0 || table.resolve(i, e) != c) fail("Claimed event not resolved", e);
+        }
+    }
+    for (int k = 0; k < 200; k++) {
+        // Events near the claimed ones, and anywhere
+        uint64_t e = k % 2 ? rng() : claimed[k % claimed.size()].eventId ^ (rng() & 0xFFFFFF00ULL);
+        if (linear_find(claimed, e) >= 0) continue;
+        int i = range_of(table, e);
+        if (i >= 0) fail("Unclaimed event in a range", e);
+    }
+    return errors;
+}
+
+/// N targets as boards of NUM_CHANNELS targets with the default Event IDs
+std::vector<Claim> board_layout(unsigned n) {
+    std::vector<Claim> claimed;
+    for (unsigned t = 0; t < n; t++) {
+        int c = t % openlcb::NUM_CHANNELS;
+        uint64_t board = t / openlcb::NUM_CHANNELS;
+        claimed.push_back({DEFAULT_EVENTS[c] + (board << 24),
+                           openlcb::channel_value_bits(c) == 8 ? 8U : 16U});
+    }
+    return claimed;
+}
+
+struct Result {
+    unsigned ranges;
+    double tableNs;
+    double linearNs;
+    int errors;
+};
+
+template <unsigned N>
+Result run(int events) {
+    static EventRangeTable<N> table;
+    std::vector<Claim> claimed = board_layout(N);
+    table.clear();
+    for (size_t i = 0; i < claimed.size(); i++) {
+        table.add(claimed[i].eventId, claimed[i].bits, i);
+    }
+    table.update_ranges();
+
+    Result result = {table.num_ranges(), 0, 0, check(table, claimed)};
+
+    // Incoming events with the range the registry matched them to
+    std::vector<uint64_t> incoming(events);
+    std::vector<unsigned> range(events);
+    for (int k = 0; k < events; k++) {
+        const Claim &c = claimed[rng() % claimed.size()];
+        incoming[k] = c.eventId + (rng() & ((1ULL << c.bits) - 1));
+        range[k] = range_of(table, incoming[k]);
+    }
+
+    unsigned sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < events; k++) sink += table.resolve(range[k], incoming[k]);
+    auto mid = std::chrono::steady_clock::now();
+    // The per-channel handlers see every event
+    int linearEvents = events / (N / openlcb::NUM_CHANNELS + 1) + 1000;
+    for (int k = 0; k < linearEvents; k++) sink += linear_find(claimed, incoming[k % events]);
+    auto end = std::chrono::steady_clock::now();
+
+    result.tableNs = std::chrono::duration<double, std::nano>(mid - start).count() / events;
+    result.linearNs = std::chrono::duration<double, std::nano>(end - mid).count() / linearEvents;
+    if (sink == 1) printf(" ");  // Keep the loops
+    return result;
+}
+
+/// Random claims in a few neighbouring blocks, 8-bit with the occasional
+/// 16-bit one
+int random_layouts() {
+    static EventRangeTable<256> table;
+    int errors = 0;
+    for (int k = 0; k < RANDOM_LAYOUTS; k++) {
+        uint64_t base = rng() & ~0x3FFFFULL;
+        std::vector<Claim> claimed;
+        table.clear();
+        int count = 1 + rng() % 200;
+        for (int i = 0; i < count; i++) {
+            Claim c = {base + ((rng() % 4) << 16), 16};
+            if (rng() % 20) c = {c.eventId | (rng() & 0xFF00), 8};
+            if (table.add(c.eventId, c.bits, claimed.size())) claimed.push_back(c);
+        }
+        table.update_ranges();
+        errors += check(table, claimed);
+    }
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int events = argc > 1 ? atoi(argv[1]) : 2000000;
+    rng.seed(argc > 2 ? atoi(argv[2]) : 1);
+
+    Result results[] = {run<10>(events), run<100>(events), run<1000>(events), run<4000>(events)};
+    const unsigned sizes[] = {10, 100, 1000, 4000};
+
+    printf("Event dispatch, %d events, default Event IDs per %d targets\n\n", events, openlcb::NUM_CHANNELS);
+    printf("%8s %8s %14s %14s %8s\n", "Targets", "Ranges", "Table ns/evt", "Linear ns/evt", "Errors");
+    int errors = 0;
+    for (int i = 0; i < 4; i++) {
+        const Result &r = results[i];
+        printf("%8u %8u %14.1f %14.1f %8d\n", sizes[i], r.ranges, r.tableNs, r.linearNs, r.errors);
+        errors += r.errors;
+    }
+    int randomErrors = random_layouts();
+    printf("\nRandom layouts: %d, errors %d\n", RANDOM_LAYOUTS, randomErrors);
+
+    if (errors || randomErrors) {
+        printf("\nFAIL: ranges do not cover exactly the claimed events\n");
+        return 1;
+    }
+    double growth = results[3].tableNs / results[0].tableNs;
+    if (growth > GROWTH_LIMIT) {
+        printf("\nFAIL: table cost grows %.1fx from %u to %u targets\n", growth, sizes[0], sizes[3]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Checks of the firmware's FrameBuffer, the pixel memory space behind frame
+// uploads.
+//
+// Runs the cases an upload goes through against a plain model of the
+// frame: bounds and clipping of writes and reads, a commit without an
+// upload showing black, a first write starting from black while later
+// writes change the frame in place, a fade ending the upload, a resize
+// dropping the frame, and the committed copy staying put while the next
+// frame is uploaded. Random region writes check that the incremental byte
+// sum always matches a full recount. Fails if any check fails.
+//
+// Usage: frame_buffer_test [writes] [seed]
+
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "FrameBuffer.h"
+
+using openlcb::FrameBuffer;
+
+namespace {
+
+constexpr uint16_t LEDS = 300;
+constexpr size_t SIZE = LEDS * FrameBuffer::BYTES_PER_PIXEL;
+
+std::mt19937 rng;
+int failures = 0;
+
+void check(bool ok, const char *what) {
+    if (ok) return;
+    failures++;
+    printf("  failed: %s\n", what);
+}
+
+uint32_t recount(const std::vector<uint8_t> &data) {
+    uint32_t sum = 0;
+    for (uint8_t b : data) sum += b;
+    return sum;
+}
+
+std::vector<uint8_t> contents(const FrameBuffer &frame) {
+    std::vector<uint8_t> data(frame.size());
+    frame.read(0, data.data(), data.size());
+    return data;
+}
+
+std::vector<uint8_t> pattern(size_t len, uint8_t seed) {
+    std::vector<uint8_t> data(len);
+    for (size_t i = 0; i < len; i++) data[i] = seed + i * 7;
+    return data;
+}
+
+void bounds() {
+    FrameBuffer frame;
+    check(frame.resize(LEDS), "first resize allocates");
+    check(frame.size() == SIZE, "size is LEDs x 4");
+    check(!frame.resize(LEDS), "same LED count keeps the buffer");
+
+    std::vector<uint8_t> data = pattern(64, 1);
+    uint8_t out[64];
+    check(frame.write(SIZE, data.data(), 64) == 0, "write at the end is refused");
+    check(frame.write(SIZE + 100, data.data(), 64) == 0, "write past the end is refused");
+    check(frame.write(SIZE - 10, data.data(), 64) == 10, "write across the end is clipped");
+    check(frame.read(SIZE, out, 64) == 0, "read at the end is refused");
+    check(frame.read(SIZE - 10, out, 64) == 10 && !memcmp(out, data.data(), 10),
+          "read across the end is clipped");
+}
+
+void upload_and_commit() {
+    FrameBuffer frame;
+    frame.resize(LEDS);
+    std::vector<uint8_t> shown(SIZE, 0xEE);
+
+    // A commit without an upload shows black
+    check(frame.commit(shown.data()) == 0 && recount(shown) == 0, "empty commit shows black");
+
+    // The first write starts from black, the next one continues the frame
+    std::vector<uint8_t> a = pattern(100, 3), b = pattern(40, 90);
+    frame.write(200, a.data(), a.size());
+    frame.write(1000, b.data(), b.size());
+    std::vector<uint8_t> model(SIZE, 0);
+    memcpy(&model[200], a.data(), a.size());
+    memcpy(&model[1000], b.data(), b.size());
+    check(contents(frame) == model, "writes build one frame");
+    check(frame.sum() == recount(model), "sum of the uploaded frame");
+
+    // Committing copies the frame; the next upload leaves the copy alone
+    check(frame.commit(shown.data()) == recount(model), "commit returns the sum");
+    check(shown == model, "commit copies the frame");
+    std::vector<uint8_t> c = pattern(16, 200);
+    frame.write(0, c.data(), c.size());
+    memcpy(&model[0], c.data(), c.size());
+    check(contents(frame) == model, "write after a commit changes the frame in place");
+    check(shown != model, "shown copy unchanged by the next upload");
+
+    // A fade ends the upload: the next write starts a new frame from black
+    frame.end_upload();
+    frame.write(8, c.data(), c.size());
+    std::vector<uint8_t> fresh(SIZE, 0);
+    memcpy(&fresh[8], c.data(), c.size());
+    check(contents(frame) == fresh && frame.sum() == recount(fresh), "write after a fade starts from black");
+
+    // ... and a commit without a write after a fade shows black
+    frame.end_upload();
+    check(frame.commit(shown.data()) == 0 && recount(shown) == 0, "commit after a fade shows black");
+
+    // A new LED count drops the frame
+    frame.write(0, a.data(), a.size());
+    check(frame.resize(LEDS / 2) && frame.size() == SIZE / 2, "resize to fewer LEDs");
+    check(frame.sum() == 0 && recount(contents(frame)) == 0, "resize drops the frame");
+}
+
+/// Random region writes, as datagrams of up to 64 bytes land; the sum must
+/// match a recount after every write
+void random_writes(int writes) {
+    FrameBuffer frame;
+    frame.resize(LEDS);
+    std::vector<uint8_t> model(SIZE, 0);
+    bool uploading = false;
+    int bad = 0;
+    for (int k = 0; k < writes; k++) {
+        if (rng() % 50 == 0) {
+            frame.end_upload();
+            uploading = false;
+        }
+        size_t offset = rng() % (SIZE + 32);
+        size_t len = 1 + rng() % 64;
+        std::vector<uint8_t> data(len);
+        for (uint8_t &b : data) b = rng();
+        size_t written = frame.write(offset, data.data(), len);
+        size_t expect = offset >= SIZE ? 0 : std::min(len, SIZE - offset);
+        if (written != expect) bad++;
+        if (written) {
+            if (!uploading) std::fill(model.begin(), model.end(), 0);
+            uploading = true;
+            memcpy(&model[offset], data.data(), written);
+        }
+        if (frame.sum() != recount(model)) bad++;
+    }
+    check(contents(frame) == model, "random writes match the model");
+    check(bad == 0, "sum matches a recount after every write");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int writes = argc > 1 ? atoi(argv[1]) : 20000;
+    rng.seed(argc > 2 ? atoi(argv[2]) : 1);
+
+    bounds();
+    upload_and_commit();
+    random_writes(writes);
+    printf("Frame buffer: %u LEDs, %d random writes, %d failures\n", LEDS, writes, failures);
+    if (failures) {
+        printf("\nFAIL: frame buffer does not behave like the pixel memory space\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Upload pixel frames to a lighting board over LCC.
+//
+// Joins a GridConnect TCP hub (OpenMRN hub, JMRI, or gc_hub with
+// pixel_node_sim) as an OpenLCB node, writes each frame to the board's
+// pixel memory space (0xA0) with memory configuration datagrams, then sends
+// the Frame Commit event. Prints each frame's CRC-32 and byte sum, and the
+// CAN traffic an upload takes, converted to bus time at 125 kbit/s.
+//
+// Usage: frame_upload [--port P] [--host H] [--node ID] [--leds N]
+//                     [--frames K] [--file F] [--commit-event ID] [--id ID]
+//
+// Without --file, frames are a moving test pattern. With --file, frames are
+// read back to back from a raw file of LEDs x 4 bytes per frame (wire order).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "HostNode.h"
+
+using namespace lcc;
+
+namespace {
+
+constexpr uint8_t PIXEL_SPACE_ID = 0xA0;
+constexpr size_t BYTES_PER_PIXEL = 4;
+constexpr size_t CHUNK = 64;            // Data bytes per write datagram
+constexpr int REPLY_TIMEOUT_MS = 3000;
+constexpr double BUS_BITS_PER_SEC = 125000;
+
+/// Write one chunk and wait for the acknowledgement and write reply.
+/// Returns false on a failure or timeout.
+bool write_chunk(HostNode &node, uint16_t dst, uint32_t address, const uint8_t *data, size_t len) {
+    uint8_t dg[DATAGRAM_MAX];
+    dg[0] = 0x20;
+    dg[1] = 0x00;  // Write, space in byte 6
+    dg[2] = address >> 24;
+    dg[3] = address >> 16;
+    dg[4] = address >> 8;
+    dg[5] = address;
+    dg[6] = PIXEL_SPACE_ID;
+    memcpy(dg + 7, data, len);
+
+    for (int attempt = 0; attempt < 10; attempt++) {
+        node.send_datagram(dst, dg, 7 + len);
+        bool replyPending = false;
+        bool resend = false;
+        HostNode::Message msg;
+        uint64_t until = host_millis() + REPLY_TIMEOUT_MS;
+        for (;;) {
+            int64_t left = (int64_t)(until - host_millis());
+            if (left <= 0 || !node.receive(&msg, left)) {
+                fprintf(stderr, "frame_upload: no datagram acknowledgement at 0x%X\n", address);
+                return false;
+            }
+            if (msg.src != dst) continue;
+            if (msg.mti == MTI_DATAGRAM_OK) {
+                replyPending = !msg.data.empty() && (msg.data[0] & 0x80);
+                break;
+            }
+            if (msg.mti == MTI_DATAGRAM_REJECTED) {
+                uint16_t code = msg.data.size() >= 2 ? msg.data[0] << 8 | msg.data[1] : 0;
+                if (!(code & 0x2000)) {
+                    fprintf(stderr, "frame_upload: datagram rejected (0x%04X)\n", code);
+                    return false;
+                }
+                resend = true;
+                break;
+            }
+        }
+        if (resend) continue;
+        if (!replyPending) return true;
+
+        // Write reply: 0x10 is success, 0x18 carries an error code
+        for (;;) {
+            int64_t left = (int64_t)(until - host_millis());
+            if (left <= 0 || !node.receive(&msg, left)) {
+                fprintf(stderr, "frame_upload: no write reply at 0x%X\n", address);
+                return false;
+            }
+            if (msg.src != dst || msg.mti != 0) continue;
+            uint8_t ok = 0;
+            node.send_addressed(MTI_DATAGRAM_OK, dst, &ok, 1);
+            if (msg.data.size() < 2 || msg.data[0] != 0x20) continue;
+            if ((msg.data[1] & 0xF8) == 0x10) return true;
+            size_t n = msg.data.size();
+            fprintf(stderr, "frame_upload: write failed at 0x%X (0x%02X%02X)\n", address,
+                    n >= 2 ? msg.data[n - 2] : 0, n >= 1 ? msg.data[n - 1] : 0);
+            return false;
+        }
+    }
+    fprintf(stderr, "frame_upload: node kept asking to resend at 0x%X\n", address);
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    int port = 12021;
+    uint64_t target = 0x050101019F62ULL;  // NODEID.h
+    uint64_t ownId = 0x0501010100FEULL;
+    size_t leds = 1000;
+    int frames = 3;
+    const char *file = nullptr;
+    uint64_t commitEvent = 0x050101019F600700ULL;  // config.h Frame commit base
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--host")) host = argv[i + 1];
+        else if (!strcmp(argv[i], "--port")) port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--node")) target = strtoull(argv[i + 1], nullptr, 0);
+        else if (!strcmp(argv[i], "--id")) ownId = strtoull(argv[i + 1], nullptr, 0);
+        else if (!strcmp(argv[i], "--leds")) leds = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--frames")) frames = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--file")) file = argv[i + 1];
+        else if (!strcmp(argv[i], "--commit-event")) commitEvent = strtoull(argv[i + 1], nullptr, 0);
+    }
+
+    size_t frameSize = leds * BYTES_PER_PIXEL;
+    FILE *in = nullptr;
+    if (file && !(in = fopen(file, "rb"))) {
+        perror(file);
+        return 1;
+    }
+
+    HostNode node(ownId);
+    if (!node.connect(host, port) || !node.start()) {
+        fprintf(stderr, "frame_upload: cannot join hub at %s:%d\n", host, port);
+        return 1;
+    }
+    uint16_t dst = node.find_alias(target, REPLY_TIMEOUT_MS);
+    if (!dst) {
+        fprintf(stderr, "frame_upload: node %012llX not found\n", (unsigned long long)target);
+        return 1;
+    }
+
+    std::vector<uint8_t> frame(frameSize);
+    unsigned startFrames = node.frames();
+    uint64_t startBits = node.bus_bits();
+    uint64_t startMs = host_millis();
+    int sent = 0;
+    for (int k = 0; k < frames; k++) {
+        if (in) {
+            if (fread(frame.data(), 1, frameSize, in) != frameSize) break;
+        } else {
+            for (size_t i = 0; i < frameSize; i++) frame[i] = (uint8_t)(i * 7 + k * 13);
+        }
+        for (size_t off = 0; off < frameSize; off += CHUNK) {
+            size_t len = frameSize - off < CHUNK ? frameSize - off : CHUNK;
+            if (!write_chunk(node, dst, off, &frame[off], len)) return 1;
+        }
+        node.send_event((commitEvent & ~0xFFULL) | (k & 0xFF));
+
+        uint32_t sum = 0;
+        for (uint8_t b : frame) sum += b;
+        printf("Frame %d: crc32 %08X sum %u\n", k + 1, crc32(frame.data(), frameSize), sum);
+        fflush(stdout);
+        sent++;
+    }
+    if (in) fclose(in);
+
+    if (!sent) return 1;
+
+    double wallMs = host_millis() - startMs;
+    double perFrame = (double)(node.frames() - startFrames) / sent;
+    double busMs = (node.bus_bits() - startBits) / (double)sent / BUS_BITS_PER_SEC * 1000;
+    printf("\n%d frames of %zu LEDs (%zu bytes) to alias %03X\n", sent, leds, frameSize, dst);
+    printf("Wall time per frame:        %8.1f ms\n", wallMs / sent);
+    printf("CAN frames per LED frame:   %8.0f\n", perFrame);
+    printf("Bus time per LED frame:     %8.1f ms at 125 kbit/s (%.2f frames/s max)\n",
+           busMs, 1000 / busMs);
+    return 0;
+}
@@ -0,0 +1,99 @@
+// GridConnect TCP hub stand-in.
+//
+// Relays every GridConnect line a client sends to all other clients, like
+// the OpenMRN hub application or a CAN-USB gateway does. Enough to connect
+// frame_upload to pixel_node_sim (or to a real hub) on one machine.
+//
+// Usage: gc_hub [port]    (default 12021)
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Client {
+    int fd;
+    std::string rx;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int port = argc > 1 ? atoi(argv[1]) : 12021;
+    signal(SIGPIPE, SIG_IGN);
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, 8) < 0) {
+        perror("gc_hub");
+        return 1;
+    }
+    printf("GridConnect hub listening on port %d\n", port);
+    fflush(stdout);
+
+    std::vector<Client> clients;
+    for (;;) {
+        std::vector<pollfd> fds;
+        fds.push_back({listener, POLLIN, 0});
+        for (Client &c : clients) fds.push_back({c.fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), -1) < 0) continue;
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd >= 0) {
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                clients.push_back({fd, ""});
+            }
+        }
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Client &c = clients[i - 1];
+            char buf[4096];
+            ssize_t got = read(c.fd, buf, sizeof(buf));
+            if (got <= 0) {
+                close(c.fd);
+                c.fd = -1;
+                continue;
+            }
+            c.rx.append(buf, got);
+            // Forward complete frames only, so lines from different clients
+            // never interleave
+            size_t end;
+            while ((end = c.rx.find(';')) != std::string::npos) {
+                std::string line = c.rx.substr(0, end + 1) + "\n";
+                c.rx.erase(0, end + 1);
+                size_t start = line.find(':');
+                if (start == std::string::npos) continue;
+                line.erase(0, start);
+                for (Client &o : clients) {
+                    if (&o == &c || o.fd < 0) continue;
+                    if (write(o.fd, line.data(), line.size()) < 0) {
+                        close(o.fd);
+                        o.fd = -1;
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < clients.size();) {
+            if (clients[i].fd < 0) {
+                clients.erase(clients.begin() + i);
+            } else {
+                i++;
+            }
+        }
+    }
+}
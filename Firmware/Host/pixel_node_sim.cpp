@@ -0,0 +1,131 @@
+// Stand-in for a lighting board's pixel memory space (0xA0).
+//
+// Joins a GridConnect hub as an OpenLCB node and answers memory
+// configuration reads and writes of the frame buffer with the firmware's
+// FrameBuffer, mapping its results to replies like PixelMemorySpace: writes
+// past the end fail, the first upload starts from black, later uploads
+// change the committed frame in place, and the power sum is kept per write.
+// On each Frame Commit event it commits the frame as RGBWStrip does and
+// prints the CRC-32 and power sum of what the strip would show, so an
+// upload can be checked end to end.
+//
+// Usage: pixel_node_sim [--port P] [--node ID] [--leds N]
+//                       [--commit-event ID] [--commits K]
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "FrameBuffer.h"
+#include "HostNode.h"
+
+using namespace lcc;
+using openlcb::FrameBuffer;
+
+namespace {
+
+constexpr uint8_t PIXEL_SPACE_ID = 0xA0;
+constexpr uint16_t ERROR_SPACE_NOT_KNOWN = 0x1081;
+constexpr uint16_t ERROR_OUT_OF_BOUNDS = 0x1082;
+
+/// Answer one memory configuration datagram; returns false if it was not one
+bool handle_memory_config(HostNode &node, const HostNode::Message &msg, FrameBuffer &frame) {
+    const std::vector<uint8_t> &d = msg.data;
+    if (d.size() < 7 || d[0] != 0x20) return false;
+    uint8_t cmd = d[1];
+    bool write = (cmd & 0xFC) == 0x00;
+    bool read = (cmd & 0xFC) == 0x40;
+    if (!write && !read) return false;
+
+    // Accept the datagram with a reply to follow
+    uint8_t ok = 0x80;
+    node.send_addressed(MTI_DATAGRAM_OK, msg.src, &ok, 1);
+
+    uint32_t address = (uint32_t)d[2] << 24 | d[3] << 16 | d[4] << 8 | d[5];
+    uint8_t spaceId = (cmd & 0x03) == 0 ? d[6] : 0xFC | (cmd & 0x03);
+    size_t header = (cmd & 0x03) == 0 ? 7 : 6;
+    std::vector<uint8_t> reply(d.begin(), d.begin() + header);
+    uint16_t error = 0;
+
+    if (spaceId != PIXEL_SPACE_ID) {
+        error = ERROR_SPACE_NOT_KNOWN;
+    } else if (write) {
+        // PixelMemorySpace::write()
+        size_t len = d.size() - header;
+        if (!frame.write(address, &d[header], len) && len) error = ERROR_OUT_OF_BOUNDS;
+    } else {
+        // PixelMemorySpace::read()
+        uint8_t data[DATAGRAM_MAX];
+        size_t count = std::min<size_t>(d.size() > header ? d[header] : 0, DATAGRAM_MAX - header);
+        size_t got = frame.read(address, data, count);
+        if (!got && count) {
+            error = ERROR_OUT_OF_BOUNDS;
+        } else {
+            reply.insert(reply.end(), data, data + got);
+        }
+    }
+
+    // Write reply 0x10 / read reply 0x50, failure adds 0x08 and the error code
+    reply[1] = (write ? 0x10 : 0x50) | (cmd & 0x03) | (error ? 0x08 : 0);
+    if (error) {
+        reply.resize(header);
+        reply.push_back(error >> 8);
+        reply.push_back(error & 0xFF);
+    }
+    node.send_datagram(msg.src, reply.data(), reply.size());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int port = 12021;
+    uint64_t nodeId = 0x050101019F62ULL;  // NODEID.h
+    size_t leds = 1000;
+    uint64_t commitEvent = 0x050101019F600700ULL;  // config.h Frame commit base
+    int commits = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--port")) port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--node")) nodeId = strtoull(argv[i + 1], nullptr, 0);
+        else if (!strcmp(argv[i], "--leds")) leds = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--commit-event")) commitEvent = strtoull(argv[i + 1], nullptr, 0);
+        else if (!strcmp(argv[i], "--commits")) commits = atoi(argv[i + 1]);
+    }
+
+    HostNode node(nodeId);
+    if (!node.connect("127.0.0.1", port) || !node.start()) {
+        fprintf(stderr, "pixel_node_sim: cannot join hub on port %d\n", port);
+        return 1;
+    }
+    printf("Pixel node %012llX alias %03X: %zu LEDs, space 0x%02X\n",
+           (unsigned long long)nodeId, node.alias(), leds, PIXEL_SPACE_ID);
+    fflush(stdout);
+
+    FrameBuffer frame;
+    frame.resize(leds);
+    std::vector<uint8_t> shown(frame.size());
+    int committed = 0;
+    HostNode::Message msg;
+    while (!node.closed()) {
+        if (!node.receive(&msg, 1000)) continue;
+        if (msg.mti == 0) {
+            if (!handle_memory_config(node, msg, frame)) {
+                // Not for us: reject permanently (not implemented)
+                uint8_t err[2] = {0x10, 0x40};
+                node.send_addressed(MTI_DATAGRAM_REJECTED, msg.src, err, 2);
+            }
+        } else if (msg.mti == MTI_EVENT_REPORT && msg.data.size() == 8 &&
+                   (get_u64(msg.data.data()) & ~0xFFULL) == (commitEvent & ~0xFFULL)) {
+            // RGBWStrip::present_frame(): a commit without any upload shows black
+            uint32_t sum = frame.commit(shown.data());
+            committed++;
+            printf("Commit %d: crc32 %08X sum %u\n", committed,
+                   crc32(shown.data(), shown.size()), sum);
+            fflush(stdout);
+            if (commits && committed >= commits) break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Power limiter benchmark for uploaded frames and scenes.
+//
+// Runs the firmware's render stage (StripRenderer with its PowerLimiter, fed
+// from the FrameBuffer behind the pixel space) on the paths a board takes
+// for a 1000 LED strip: region writes in datagram sized chunks (each
+// adjusting the power estimate), the commit, and the power limit scaling the
+// frame into the strip as the cap drops and recovers; then solid scenes
+// from the fade engine under the same budget. Checks after every frame that
+// the incremental estimate equals a full rescan, that the strip shows the
+// frame or scene at the settled cap and within the budget, and that frames
+// come back intact after the cap has dipped to 0. Reports the cost per frame
+// and fails above the limit.
+//
+// Usage: power_bench [leds] [frames] [seed]
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "FrameBuffer.h"
+#include "PowerLimiter.h"
+#include "StripRenderer.h"
+
+using openlcb::FrameBuffer;
+using openlcb::PowerLimiter;
+using openlcb::SceneValues;
+using openlcb::StripRenderer;
+
+namespace {
+
+constexpr size_t BYTES_PER_PIXEL = StripRenderer::BYTES_PER_PIXEL;
+constexpr size_t CHUNK = 64;            // Data bytes per write datagram
+constexpr uint16_t BUDGET_MA = 5000;
+constexpr uint16_t CHANNEL_MA = 20;
+constexpr uint32_t IDLE_MA_PER_LED = 1;
+/// Limit per 1000 LEDs, well under the 16 ms show interval
+constexpr double FRAME_LIMIT_MS = 0.5;
+
+std::mt19937 rng;
+
+uint32_t rescan(const std::vector<uint8_t> &data) {
+    uint32_t sum = 0;
+    for (uint8_t b : data) sum += b;
+    return sum;
+}
+
+/// Old frame mode behaviour: Adafruit_NeoPixel::setBrightness() rescales
+/// the pixels in place from the previous brightness (same arithmetic)
+void set_brightness_in_place(std::vector<uint8_t> &pixels, uint8_t *stored, uint8_t brightness) {
+    uint8_t newBrightness = brightness + 1;
+    if (newBrightness == *stored) return;
+    uint8_t oldBrightness = *stored - 1;
+    uint16_t scale;
+    if (oldBrightness == 0) scale = 0;
+    else if (brightness == 255) scale = 65535 / oldBrightness;
+    else scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+    for (uint8_t &c : pixels) c = (c * scale) >> 8;
+    *stored = newBrightness;
+}
+
+/// Show frames one interval apart until the cap has settled, as the
+/// render task does
+void settle(StripRenderer &renderer, unsigned long *nowMs) {
+    do {
+        *nowMs += StripRenderer::MIN_SHOW_INTERVAL_MS;
+        renderer.flush(*nowMs);
+    } while (renderer.limiter().recovering());
+}
+
+/// True if strip holds frame at brightness cap
+bool shows(const std::vector<uint8_t> &strip, const std::vector<uint8_t> &frame, uint8_t cap) {
+    std::vector<uint8_t> expect(frame.size());
+    PowerLimiter::scale(frame.data(), expect.data(), frame.size(), cap);
+    return strip == expect;
+}
+
+/// True if strip holds the scene at brightness cap
+bool shows_scene(const std::vector<uint8_t> &strip, const SceneValues &v, uint8_t cap) {
+    uint8_t color[BYTES_PER_PIXEL] = {v.w, v.r, v.g, v.b};
+    std::vector<uint8_t> frame(strip.size());
+    for (size_t i = 0; i < frame.size(); i++) frame[i] = color[i % BYTES_PER_PIXEL];
+    return shows(strip, frame, cap);
+}
+
+/// Full rescan of the current the strip draws as shown
+uint32_t shown_ma(const std::vector<uint8_t> &strip) {
+    return strip.size() / BYTES_PER_PIXEL * IDLE_MA_PER_LED +
+           (uint64_t)rescan(strip) * CHANNEL_MA / 255;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t leds = argc > 1 ? atoi(argv[1]) : 1000;
+    int frames = argc > 2 ? atoi(argv[2]) : 2000;
+    rng.seed(argc > 3 ? atoi(argv[3]) : 1);
+    size_t size = leds * BYTES_PER_PIXEL;
+
+    std::vector<uint8_t> strip(size), contents(size), next(size), legacy(size);
+    FrameBuffer frame;
+    frame.resize(leds);
+    StripRenderer renderer;
+    renderer.attach(strip.data(), leds);
+    renderer.configure(BUDGET_MA, CHANNEL_MA);
+    unsigned long nowMs = 0;
+    int sumErrors = 0;
+    int frameErrors = 0;
+    int sceneErrors = 0;
+    int overBudget = 0;
+    int legacyWorn = 0;
+    double frameMs = 0;
+    double sceneMs = 0;
+
+    for (int k = 0; k < frames; k++) {
+        // Every other frame is bright enough to exceed the budget, so the cap
+        // keeps dropping and recovering
+        int peak = k % 2 ? 255 : 40;
+        for (uint8_t &b : next) b = std::uniform_int_distribution<int>(0, peak)(rng);
+        // Some uploads only change part of the frame
+        size_t changed = k % 3 == 0 ? size / 4 : size;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t off = 0; off < changed; off += CHUNK) {
+            size_t len = changed - off < CHUNK ? changed - off : CHUNK;
+            frame.write(off, &next[off], len);
+        }
+        renderer.show_frame(frame);
+        settle(renderer, &nowMs);
+        frameMs += std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start).count();
+
+        frame.read(0, contents.data(), size);
+        if (frame.sum() != rescan(contents) ||
+            renderer.limiter().estimate_ma(255) != shown_ma(contents)) sumErrors++;
+        if (!shows(strip, contents, renderer.applied())) frameErrors++;
+        if (renderer.applied() < 255 && shown_ma(strip) > BUDGET_MA) overBudget++;
+
+        // A load spike elsewhere on the supply: the budget drops below the
+        // LEDs' idle current, so the cap reaches 0, then returns. The frame
+        // must come back intact.
+        uint8_t settledCap = renderer.applied();
+        renderer.configure(1, CHANNEL_MA);
+        settle(renderer, &nowMs);
+        uint8_t dipCap = renderer.applied();
+        renderer.configure(BUDGET_MA, CHANNEL_MA);
+        settle(renderer, &nowMs);
+        if (dipCap != 0 || renderer.applied() != settledCap ||
+            !shows(strip, contents, settledCap)) frameErrors++;
+
+        // The same dip under the old in-place rescale
+        PowerLimiter::scale(contents.data(), legacy.data(), size, settledCap);
+        uint8_t stored = settledCap + 1;
+        set_brightness_in_place(legacy, &stored, dipCap);
+        set_brightness_in_place(legacy, &stored, settledCap);
+        if (!shows(legacy, contents, settledCap)) legacyWorn++;
+
+        // A fade step from the engine: a solid scene, bright enough on
+        // every other step to be capped
+        SceneValues v;
+        v.r = rng();
+        v.g = rng();
+        v.b = rng();
+        v.w = k % 2 ? 255 : rng() % 64;
+        v.brightness = rng();
+        start = std::chrono::steady_clock::now();
+        renderer.show_scene(v);
+        frame.end_upload();
+        settle(renderer, &nowMs);
+        sceneMs += std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start).count();
+
+        uint8_t cap = renderer.applied();
+        if (cap > v.brightness || !shows_scene(strip, v, cap)) sceneErrors++;
+        if (cap < v.brightness && shown_ma(strip) > BUDGET_MA) overBudget++;
+    }
+
+    // Shows are paced: a second one inside the interval is held back
+    renderer.show_scene(SceneValues{1, 2, 3, 4, 5});
+    bool paced = !renderer.flush(nowMs) && renderer.flush(nowMs + StripRenderer::MIN_SHOW_INTERVAL_MS);
+    if (!paced) sceneErrors++;
+
+    double perFrame = frameMs / frames;
+    double perScene = sceneMs / frames;
+    double per1000 = std::max(perFrame, perScene) * 1000 / leds;
+    printf("Power limiter, %d frames and scenes of %zu LEDs (budget %u mA, %u mA per channel, %u mA idle per LED)\n\n",
+           frames, leds, BUDGET_MA, CHANNEL_MA, IDLE_MA_PER_LED);
+    printf("Mean cost per uploaded frame: %8.4f ms\n", perFrame);
+    printf("Mean cost per scene:          %8.4f ms\n", perScene);
+    printf("Estimate differs from rescan: %8d frames\n", sumErrors);
+    printf("Strip differs from frame:     %8d frames\n", frameErrors);
+    printf("Strip differs from scene:     %8d scenes\n", sceneErrors);
+    printf("Capped but over budget:       %8d\n", overBudget);
+    printf("Worn by in-place rescale:     %8d frames (previous behaviour, for comparison)\n", legacyWorn);
+
+    if (sumErrors || frameErrors || sceneErrors || overBudget) {
+        printf("\nFAIL: strip, power estimate or budget drifted\n");
+        return 1;
+    }
+    if (per1000 > FRAME_LIMIT_MS) {
+        printf("\nFAIL: above %.1f ms per 1000 LEDs\n", FRAME_LIMIT_MS);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,340 @@
+// Replay a recorded event trace into the firmware's fade engine and render
+// stage.
+//
+// Reads a trace dump, either binary (read from memory space 0xA1) or a
+// serial capture holding the "@T" lines of the 'T' command among the log
+// output, and feeds every strip channel event to SceneEngine at the time it
+// was recorded, the way RGBWStrip does on the board. Each step is rendered
+// by the board's StripRenderer, with its power limit and show schedule, and
+// the resulting pixel frames can be written out (LEDs x 4 bytes each, wire
+// order, the format frame_upload takes), so a glitch can be bisected
+// offline. Uploaded frame contents are not in the trace, so a Frame Commit
+// shows black.
+//
+// Runs as fast as possible by default, or in real time with --realtime.
+// Reports the densest burst of events and the worst processing time of an
+// event and of a shown frame.
+//
+// Usage: trace_replay <trace> [--leds N] [--budget mA] [--channel-current mA]
+//                     [--out F] [--log] [--realtime] [--expect R,G,B,W,Br]
+
+#include <chrono>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameBuffer.h"
+#include "SceneEngine.h"
+#include "StripRenderer.h"
+#include "TraceFormat.h"
+
+using openlcb::FrameBuffer;
+using openlcb::SceneEngine;
+using openlcb::SceneValues;
+using openlcb::StripRenderer;
+
+namespace {
+
+constexpr unsigned long MIN_SHOW_INTERVAL_MS = StripRenderer::MIN_SHOW_INTERVAL_MS;
+constexpr size_t BYTES_PER_PIXEL = StripRenderer::BYTES_PER_PIXEL;
+/// Replay continues after the last event until fades end, at most this long
+constexpr unsigned long MAX_TAIL_MS = 300000;
+
+struct Event {
+    uint64_t timeUs;    // Recording time, unwrapped
+    bool sent;
+    int channel;
+    uint64_t event;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_us(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+uint32_t get_u32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+uint64_t get_u64(const uint8_t *p) {
+    return get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+/// Load a dump file: binary, or text with "@T <offset> <hex>" lines
+bool load_dump(const char *path, std::vector<uint8_t> *dump) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    std::vector<uint8_t> raw;
+    uint8_t buf[4096];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) raw.insert(raw.end(), buf, buf + got);
+    fclose(f);
+
+    if (raw.size() >= 4 && !memcmp(raw.data(), openlcb::TRACE_MAGIC, 4)) {
+        *dump = raw;
+        return true;
+    }
+
+    // Serial capture: pick the dump lines out of the log, placing each by
+    // its offset so a missing line shows up as a gap
+    std::string text(raw.begin(), raw.end());
+    std::vector<bool> have;
+    size_t pos = 0;
+    while ((pos = text.find("@T ", pos)) != std::string::npos) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(pos + 3, end - pos - 3);
+        pos = end;
+        if (line.compare(0, 3, "END") == 0) continue;
+        char *rest;
+        unsigned long offset = strtoul(line.c_str(), &rest, 16);
+        while (*rest == ' ') rest++;
+        size_t n = 0;
+        for (; isxdigit(rest[2 * n]) && isxdigit(rest[2 * n + 1]); n++) {}
+        if (dump->size() < offset + n) {
+            dump->resize(offset + n);
+            have.resize(offset + n);
+        }
+        for (size_t i = 0; i < n; i++) {
+            char hex[3] = {rest[2 * i], rest[2 * i + 1], 0};
+            (*dump)[offset + i] = strtoul(hex, nullptr, 16);
+            have[offset + i] = true;
+        }
+    }
+    for (size_t i = 0; i < have.size(); i++) {
+        if (!have[i]) {
+            fprintf(stderr, "%s: dump line missing at offset 0x%zX\n", path, i);
+            return false;
+        }
+    }
+    if (dump->empty()) {
+        fprintf(stderr, "%s: no trace dump found\n", path);
+        return false;
+    }
+    return true;
+}
+
+/// Parse the header and records; returns false if the dump is not usable
+bool parse_dump(const std::vector<uint8_t> &dump, std::vector<Event> *events,
+                bool *controller, unsigned *dropped) {
+    using namespace openlcb;
+    if (dump.size() < TRACE_HEADER_SIZE || memcmp(dump.data(), TRACE_MAGIC, 4)) {
+        fprintf(stderr, "trace_replay: not a trace dump\n");
+        return false;
+    }
+    if (dump[TRACE_VERSION_OFFSET] != TRACE_FORMAT_VERSION ||
+        dump[TRACE_RECORD_SIZE_OFFSET] != TRACE_RECORD_SIZE) {
+        fprintf(stderr, "trace_replay: format version %d is not supported (expected %d)\n",
+                dump[TRACE_VERSION_OFFSET], TRACE_FORMAT_VERSION);
+        return false;
+    }
+    size_t count = dump[TRACE_COUNT_OFFSET] | dump[TRACE_COUNT_OFFSET + 1] << 8;
+    *dropped = dump[TRACE_DROPPED_OFFSET] | dump[TRACE_DROPPED_OFFSET + 1] << 8;
+    *controller = dump[TRACE_FLAGS_OFFSET] & TRACE_HEADER_FLAG_CONTROLLER;
+    if (dump.size() < TRACE_HEADER_SIZE + count * TRACE_RECORD_SIZE) {
+        fprintf(stderr, "trace_replay: dump truncated (%zu of %zu records)\n",
+                (dump.size() - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE, count);
+        return false;
+    }
+
+    // micros() wraps every 71 minutes
+    uint64_t base = 0;
+    uint32_t last = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *rec = &dump[TRACE_HEADER_SIZE + i * TRACE_RECORD_SIZE];
+        uint32_t timeUs = get_u32(rec);
+        if (i > 0 && timeUs < last) base += 1ULL << 32;
+        last = timeUs;
+        Event e;
+        e.timeUs = base + timeUs;
+        e.sent = rec[4] & TRACE_FLAG_SENT;
+        e.channel = (rec[4] >> TRACE_CHANNEL_SHIFT & 0x0F) - 1;
+        e.event = get_u64(rec + 5);
+        events->push_back(e);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: trace_replay <trace> [--leds N] [--budget mA] [--channel-current mA]\n"
+                        "                    [--out F] [--log] [--realtime] [--expect R,G,B,W,Br]\n");
+        return 1;
+    }
+    const char *path = argv[1];
+    size_t leds = 120;  // RGBWStrip default LED count
+    unsigned budgetMa = 0;
+    unsigned channelMa = 20;
+    const char *outPath = nullptr;
+    bool log = false;
+    bool realtime = false;
+    const char *expect = nullptr;
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "--log")) log = true;
+        else if (!strcmp(argv[i], "--realtime")) realtime = true;
+        else if (i + 1 < argc && !strcmp(argv[i], "--leds")) leds = atoi(argv[++i]);
+        else if (i + 1 < argc && !strcmp(argv[i], "--budget")) budgetMa = atoi(argv[++i]);
+        else if (i + 1 < argc && !strcmp(argv[i], "--channel-current")) channelMa = atoi(argv[++i]);
+        else if (i + 1 < argc && !strcmp(argv[i], "--out")) outPath = argv[++i];
+        else if (i + 1 < argc && !strcmp(argv[i], "--expect")) expect = argv[++i];
+    }
+
+    std::vector<uint8_t> dump;
+    std::vector<Event> events;
+    bool controller;
+    unsigned dropped;
+    if (!load_dump(path, &dump) || !parse_dump(dump, &events, &controller, &dropped)) return 1;
+    if (events.empty()) {
+        fprintf(stderr, "trace_replay: the trace holds no events\n");
+        return 1;
+    }
+    FILE *out = nullptr;
+    if (outPath && !(out = fopen(outPath, "wb"))) {
+        perror(outPath);
+        return 1;
+    }
+
+    // The engine runs on micros(), as on the board; the render task polls
+    // it once per ms and renders through the board's StripRenderer
+    SceneEngine engine;
+    engine.set_timebase_source(controller);
+    std::vector<uint8_t> pixels(leds * BYTES_PER_PIXEL);
+    FrameBuffer frame;
+    frame.resize(leds);
+    StripRenderer renderer;
+    renderer.attach(pixels.data(), leds);
+    renderer.configure(budgetMa, channelMa);
+    unsigned capped = 0;
+    uint8_t lowestCap = 255;
+    unsigned channelCounts[openlcb::NUM_CHANNELS] = {};
+    unsigned otherEvents = 0;
+    unsigned shown = 0;
+    unsigned commits = 0;
+    double worstEventUs = 0;
+    double worstFrameUs = 0;
+    unsigned burst = 0;
+    unsigned long burstStart = 0;
+
+    unsigned long first = events.front().timeUs / 1000;
+    unsigned long lastEvent = events.back().timeUs / 1000;
+    bool dirty = false;
+    bool commitPending = false;
+    size_t next = 0;
+    Clock::time_point wallStart = Clock::now();
+
+    // One pass of the render task per ms, like the board
+    for (unsigned long now = first;; now++) {
+        bool settling = dirty || renderer.limiter().recovering();
+        if (next == events.size() &&
+            ((!engine.fading() && !engine.scheduled() && !settling) || now - lastEvent > MAX_TAIL_MS)) {
+            break;
+        }
+        if (realtime) {
+            std::this_thread::sleep_until(wallStart + std::chrono::milliseconds(now - first));
+        }
+
+        for (; next < events.size() && events[next].timeUs / 1000 <= now; next++) {
+            const Event &e = events[next];
+            if (e.channel < 0 || e.channel >= openlcb::NUM_CHANNELS) {
+                otherEvents++;
+                continue;
+            }
+            channelCounts[e.channel]++;
+            if (e.channel == 9) {
+                commits++;
+                commitPending = true;
+            }
+
+            // Densest run of events within one show interval
+            size_t j = next;
+            while (j < events.size() &&
+                   (events[j].timeUs - e.timeUs) / 1000 < MIN_SHOW_INTERVAL_MS) j++;
+            if (j - next > burst) {
+                burst = j - next;
+                burstStart = now;
+            }
+
+            Clock::time_point start = Clock::now();
+            engine.channel_event(e.timeUs, e.channel, e.event & openlcb::channel_value_mask(e.channel));
+            worstEventUs = std::max(worstEventUs, elapsed_us(start));
+        }
+
+        // RGBWStrip::poll_fade()
+        Clock::time_point start = Clock::now();
+        if (commitPending) {
+            commitPending = false;
+            renderer.show_frame(frame);
+            dirty = true;
+        } else if (engine.poll(now * 1000)) {
+            renderer.show_scene(engine.current());
+            frame.end_upload();
+            dirty = true;
+        }
+        if (renderer.flush(now)) {
+            const SceneValues &v = engine.current();
+            uint8_t cap = renderer.applied();
+            if (out) fwrite(pixels.data(), 1, pixels.size(), out);
+            worstFrameUs = std::max(worstFrameUs, elapsed_us(start));
+            if (log) {
+                if (renderer.frame_mode()) {
+                    printf("%10.3f s  frame", (now - first) / 1000.0);
+                } else {
+                    printf("%10.3f s  R=%3d G=%3d B=%3d W=%3d Br=%3d", (now - first) / 1000.0,
+                           v.r, v.g, v.b, v.w, v.brightness);
+                }
+                if (cap < (renderer.frame_mode() ? 255 : v.brightness)) printf("  capped at %d", cap);
+                printf("\n");
+            }
+            if (cap < (renderer.frame_mode() ? 255 : v.brightness)) {
+                capped++;
+                lowestCap = std::min(lowestCap, cap);
+            }
+            dirty = false;
+            shown++;
+        }
+    }
+    double wallMs = elapsed_us(wallStart) / 1000;
+    if (out) fclose(out);
+
+    const char *names[] = {"Red", "Green", "Blue", "White", "Brightness", "Duration", "Stream",
+                           "Timebase", "Sync Duration", "Frame", "Start Epoch"};
+    const SceneValues &v = engine.current();
+    printf("%s trace, %zu events over %.3f s", controller ? "Controller" : "Follower",
+           events.size(), (lastEvent - first) / 1000.0);
+    if (dropped) printf(" (%u dropped while the trace was read)", dropped);
+    printf("\n\n");
+    for (int c = 0; c < openlcb::NUM_CHANNELS; c++) {
+        if (channelCounts[c]) printf("  %-14s %6u\n", names[c], channelCounts[c]);
+    }
+    if (otherEvents) printf("  %-14s %6u\n", "Other", otherEvents);
+    printf("\nFrames shown:               %8u (%zu LEDs)\n", shown, leds);
+    if (budgetMa) printf("Power limited:              %8u (budget %u mA, lowest cap %d)\n", capped, budgetMa, lowestCap);
+    if (commits) printf("Frame commits:              %8u (uploaded contents not in the trace, shown black)\n", commits);
+    printf("Densest burst:              %8u events within %lu ms at %.3f s\n",
+           burst, MIN_SHOW_INTERVAL_MS, (burstStart - first) / 1000.0);
+    printf("Worst event processing:     %8.2f us\n", worstEventUs);
+    printf("Worst shown frame:          %8.2f us\n", worstFrameUs);
+    printf("Replay time:                %8.1f ms%s\n", wallMs, realtime ? " (real time)" : "");
+    printf("Final scene:                R=%d G=%d B=%d W=%d Br=%d\n",
+           v.r, v.g, v.b, v.w, v.brightness);
+
+    if (expect) {
+        int r, g, b, w, br;
+        if (sscanf(expect, "%d,%d,%d,%d,%d", &r, &g, &b, &w, &br) != 5 ||
+            v != SceneValues{(uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)w, (uint8_t)br}) {
+            printf("\nFAIL: final scene differs from %s\n", expect);
+            return 1;
+        }
+    }
+    return 0;
+}
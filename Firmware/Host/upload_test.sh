@@ -0,0 +1,33 @@
+#!/bin/sh
+# End-to-end frame upload test: gc_hub, pixel_node_sim and frame_upload on
+# one machine. Passes if every committed frame arrives with the CRC and
+# power sum the uploader sent.
+#
+# Usage: upload_test.sh <build dir> [frames] [leds]
+
+BUILD=${1:-build}
+FRAMES=${2:-3}
+LEDS=${3:-1000}
+PORT=$((20000 + $$ % 10000))
+OUT=$(mktemp -d)
+
+$BUILD/gc_hub $PORT > $OUT/hub.log &
+HUB=$!
+trap 'kill $HUB 2>/dev/null; rm -rf $OUT' EXIT
+sleep 0.2
+
+timeout 60 $BUILD/pixel_node_sim --port $PORT --leds $LEDS --commits $FRAMES > $OUT/node.log &
+NODE=$!
+sleep 0.5
+
+$BUILD/frame_upload --port $PORT --leds $LEDS --frames $FRAMES | tee $OUT/upload.log || exit 1
+wait $NODE || exit 1
+
+grep '^Frame' $OUT/upload.log | sed 's/^Frame/Commit/' > $OUT/sent
+grep '^Commit' $OUT/node.log > $OUT/received
+if ! cmp -s $OUT/sent $OUT/received; then
+    echo "FAIL: frames received by the node differ from those sent"
+    diff $OUT/sent $OUT/received
+    exit 1
+fi
+echo "All $FRAMES frames received intact"
@@ -0,0 +1,12 @@
+#ifndef __ADCINPUTCONFIG_H
+#define __ADCINPUTCONFIG_H
+
+#include "openlcb/ConfigRepresentation.hxx"
+
+CDI_GROUP(AdcInputConfig);
+CDI_GROUP_ENTRY(event, openlcb::EventConfigEntry,
+    Name("Input Event"),
+    Description("Controller only: Event ID base this input sends its value (0-255) on. Can be any channel event of any zone, including Brightness and Duration. Set to 00.00.00.00.00.00.00.00 to disable the input. Must end in 00."));
+CDI_GROUP_END();
+
+#endif // __ADCINPUTCONFIG_H
@@ -0,0 +1,142 @@
+#include "AdcPanel.h"
+#include <Wire.h>
+
+namespace openlcb {
+
+static const ADS1115_MUX ADC_CHANNELS[AdcPanel::INPUTS_PER_CHIP] = {
+    ADS1115_COMP_0_GND, ADS1115_COMP_1_GND,
+    ADS1115_COMP_2_GND, ADS1115_COMP_3_GND
+};
+
+// ADS1115 config register: start a single conversion (OS), +/-4.096V range,
+// single-shot mode, 250 SPS, comparator disabled. The mux channel is ORed in.
+static const uint8_t ADS1115_CONFIG_REG = 0x01;
+static const uint16_t ADS1115_START_SINGLE = 0x8000 | ADS1115_RANGE_4096 | ADS1115_SINGLE |
+                                             ADS1115_250_SPS | ADS1115_DISABLE_ALERT;
+
+AdcPanel::AdcPanel(const AdcInputGroup &cfg)
+    : cfg_(cfg), numChips_(0), muxIndex_(0), primed_(false) {
+    for (int i = 0; i < MAX_CHIPS; i++) {
+        chips_[i] = nullptr;
+    }
+    for (int i = 0; i < NUM_ADC_INPUTS; i++) {
+        values_[i] = 0;
+        inputEvents_[i] = 0;
+    }
+}
+
+AdcPanel::~AdcPanel() {
+    for (int i = 0; i < MAX_CHIPS; i++) {
+        if (chips_[i]) delete chips_[i];
+    }
+}
+
+ConfigUpdateListener::UpdateAction AdcPanel::apply_configuration(int fd, bool initial_load,
+                                            BarrierNotifiable *done) {
+    AutoNotify n(done);
+
+    // Read the whole mapping first, then swap it in at once: loop() reads
+    // it while the executor applies a configuration
+    uint64_t events[NUM_ADC_INPUTS];
+    for (int i = 0; i < NUM_ADC_INPUTS; i++) {
+        if (fd >= 0) {
+            events[i] = cfg_.entry(i).event().read(fd);
+        } else {
+            // Default mapping: first four inputs drive R, G, B, W
+            events[i] = i < INPUTS_PER_CHIP ? RGBW_EVENT_INIT[i] : 0;
+        }
+    }
+
+    OSMutexLock h(&lock_);
+    for (int i = 0; i < NUM_ADC_INPUTS; i++) {
+        inputEvents_[i] = events[i];
+    }
+    return UPDATED;
+}
+
+uint64_t AdcPanel::input_event(int input) {
+    if (!present(input)) return 0;
+    OSMutexLock h(&lock_);
+    return inputEvents_[input];
+}
+
+void AdcPanel::factory_reset(int fd) {
+    for (int i = 0; i < NUM_ADC_INPUTS; i++) {
+        cfg_.entry(i).event().write(fd, i < INPUTS_PER_CHIP ? RGBW_EVENT_INIT[i] : 0);
+    }
+}
+
+uint8_t AdcPanel::begin() {
+    numChips_ = 0;
+    for (int i = 0; i < MAX_CHIPS; i++) {
+        ADS1115_WE *adc = new ADS1115_WE(BASE_ADDRESS + i);
+        if (!adc->init()) {
+            delete adc;
+            continue;
+        }
+        // Single-shot mode: the library only blocks on channel and range
+        // changes in continuous mode. poll() starts each conversion itself.
+        adc->setMeasureMode(ADS1115_SINGLE);
+        adc->setVoltageRange_mV(ADS1115_RANGE_4096);
+        adc->setConvRate(ADS1115_250_SPS);
+        chips_[i] = adc;
+        numChips_++;
+        Serial.printf("ADS1115 detected at 0x%02X (inputs %d-%d)\n",
+                     BASE_ADDRESS + i, i * INPUTS_PER_CHIP + 1, (i + 1) * INPUTS_PER_CHIP);
+    }
+    muxIndex_ = 0;
+    primed_ = false;
+    return numChips_;
+}
+
+uint16_t AdcPanel::poll() {
+    if (numChips_ == 0) return 0;
+
+    // On first call, just start the first conversion on every chip
+    if (!primed_) {
+        for (int c = 0; c < MAX_CHIPS; c++) {
+            if (chips_[c]) start_conversion(c, 0);
+        }
+        muxIndex_ = 0;
+        primed_ = true;
+        return 0;
+    }
+
+    // Collect the conversions started by the last poll. At 250 SPS each takes
+    // about 4 ms, so they have finished by the next 10 ms poll.
+    uint16_t changed = 0;
+    for (int c = 0; c < MAX_CHIPS; c++) {
+        if (!chips_[c]) continue;
+        float voltage = chips_[c]->getResult_mV();
+        long clamped = constrain((long)voltage, 0, 3300);
+        uint8_t mapped = map(clamped, 0, 3300, 0, 255);
+
+        // Hysteresis: ignore changes < 2 to reduce jitter
+        int input = c * INPUTS_PER_CHIP + muxIndex_;
+        if (abs((int)mapped - (int)values_[input]) >= 2) {
+            values_[input] = mapped;
+            changed |= 1U << input;
+        }
+    }
+
+    // Start the next channel on every chip, one register write each
+    muxIndex_ = (muxIndex_ + 1) % INPUTS_PER_CHIP;
+    for (int c = 0; c < MAX_CHIPS; c++) {
+        if (chips_[c]) start_conversion(c, muxIndex_);
+    }
+    return changed;
+}
+
+void AdcPanel::start_conversion(int chip, uint8_t mux) {
+    // Write the whole config register instead of going through
+    // setCompareChannels() and startSingleMeasurement(), which each read it
+    // back first
+    uint16_t config = ADS1115_START_SINGLE | ADC_CHANNELS[mux];
+    Wire.beginTransmission(BASE_ADDRESS + chip);
+    Wire.write(ADS1115_CONFIG_REG);
+    Wire.write((uint8_t)(config >> 8));
+    Wire.write((uint8_t)(config & 0xFF));
+    Wire.endTransmission();
+}
+
+} // namespace openlcb
@@ -0,0 +1,72 @@
+#ifndef __ADCPANEL_H
+#define __ADCPANEL_H
+
+#include <ADS1115_WE.h>
+#include "os/OS.hxx"
+#include "utils/ConfigUpdateListener.hxx"
+#include "config.h"
+
+namespace openlcb {
+
+/// Control panel of up to four ADS1115 ADCs (16 pots) on the I2C bus.
+///
+/// The chips run in single-shot mode. Each poll reads the conversion every
+/// chip finished since the previous poll and starts the next mux channel on
+/// all of them with one register write per chip, so poll() never waits for a
+/// conversion and the chips convert while the loop does other work. The scan
+/// rate per input is one poll per channel, with one chip or four.
+class AdcPanel : public DefaultConfigUpdateListener {
+public:
+    AdcPanel(const AdcInputGroup &cfg);
+    ~AdcPanel();
+
+    UpdateAction apply_configuration(int fd, bool initial_load,
+                                     BarrierNotifiable *done) OVERRIDE;
+
+    void factory_reset(int fd) OVERRIDE;
+
+    /// Probe all I2C addresses and configure the chips found.
+    /// Returns the number of chips detected.
+    uint8_t begin();
+
+    /// Number of ADS1115 chips detected
+    uint8_t num_chips() { return numChips_; }
+
+    /// Read the finished conversions and start the next ones. Call every
+    /// ~10ms (a conversion takes ~4ms). Returns a bit mask of the inputs
+    /// whose value changed.
+    uint16_t poll();
+
+    /// Latest value of an input (0-255)
+    uint8_t value(int input) { return values_[input]; }
+
+    /// Event ID base an input is mapped to (0 = disabled or chip missing).
+    /// Safe to call while the executor applies a new configuration.
+    uint64_t input_event(int input);
+
+    /// True if the chip for this input was detected
+    bool present(int input) { return chips_[input / INPUTS_PER_CHIP] != nullptr; }
+
+    static constexpr uint8_t MAX_CHIPS = 4;
+    static constexpr uint8_t INPUTS_PER_CHIP = 4;
+    static constexpr uint8_t BASE_ADDRESS = 0x48;
+
+private:
+    /// Start a single conversion of a mux channel on a chip
+    void start_conversion(int chip, uint8_t mux);
+
+    const AdcInputGroup cfg_;
+    ADS1115_WE *chips_[MAX_CHIPS];     // nullptr if not detected
+    uint8_t numChips_;
+    uint8_t muxIndex_;                 // Channel currently converting on every chip
+    bool primed_;                      // First conversion has been started
+    uint8_t values_[NUM_ADC_INPUTS];
+    
+    // Written by the executor (configuration), read from loop()
+    OSMutex lock_;                     // Guards inputEvents_
+    uint64_t inputEvents_[NUM_ADC_INPUTS];
+};
+
+} // namespace openlcb
+
+#endif // __ADCPANEL_H
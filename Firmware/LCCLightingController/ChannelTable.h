@@ -0,0 +1,81 @@
+#ifndef __CHANNELTABLE_H
+#define __CHANNELTABLE_H
+
+#include <stdint.h>
+#include "EventRangeTable.h"
+#include "SceneEngine.h"
+
+namespace openlcb {
+
+/// The channels of the strips on a node and the event ranges they consume.
+///
+/// Keeps one target per (strip, channel) in an EventRangeTable, so the
+/// ranges to register and to name in Range Identified replies, and the
+/// target of an incoming event, come from the same code on the board
+/// (RGBWEventDispatcher) and in the host simulations. Has no knowledge of
+/// OpenMRN; Strip is only stored.
+template <class Strip, unsigned MAX_TARGETS>
+class ChannelTable {
+public:
+    using Table = EventRangeTable<MAX_TARGETS>;
+
+    struct Target {
+        Strip *strip;
+        uint8_t channel;
+        uint64_t eventId;
+    };
+
+    ChannelTable() : numTargets_(0) {}
+
+    /// Route the events of a strip channel to that strip. Takes effect at the
+    /// next update_ranges(). Returns false if the table is full or the
+    /// events overlap a channel that was added earlier.
+    bool add_channel(Strip *strip, int channel, uint64_t eventId) {
+        if (numTargets_ >= MAX_TARGETS) return false;
+        // 8-bit channels take one 256 event block, 16-bit channels a 64K block
+        if (!table_.add(eventId, channel_value_bits(channel) == 8 ? 8 : 16, numTargets_)) {
+            return false;
+        }
+        targets_[numTargets_++] = {strip, (uint8_t)channel, eventId};
+        return true;
+    }
+
+    /// Remove all channels of a strip (before re-adding on config change)
+    void remove_strip(Strip *strip) {
+        // Rebuild the table from the targets that remain
+        Target keep[MAX_TARGETS];
+        unsigned numKeep = 0;
+        for (unsigned i = 0; i < numTargets_; i++) {
+            if (targets_[i].strip != strip) keep[numKeep++] = targets_[i];
+        }
+        numTargets_ = 0;
+        table_.clear();
+        for (unsigned i = 0; i < numKeep; i++) {
+            add_channel(keep[i].strip, keep[i].channel, keep[i].eventId);
+        }
+    }
+
+    /// Recompute the minimal set of ranges
+    void update_ranges() { table_.update_ranges(); }
+
+    unsigned num_ranges() const { return table_.num_ranges(); }
+    const typename Table::Range &range(unsigned i) const { return table_.range(i); }
+
+    /// Event ID naming range i in a Consumer Range Identified message
+    uint64_t identifier(unsigned i) const { return table_.identifier(i); }
+
+    /// Target of an event within range i, or nullptr
+    const Target *resolve(unsigned i, uint64_t event) const {
+        unsigned index = table_.resolve(i, event);
+        return index == Table::NO_TARGET ? nullptr : &targets_[index];
+    }
+
+private:
+    Target targets_[MAX_TARGETS];
+    unsigned numTargets_;
+    Table table_;
+};
+
+} // namespace openlcb
+
+#endif // __CHANNELTABLE_H
@@ -0,0 +1,134 @@
+#ifndef __EVENTRANGETABLE_H
+#define __EVENTRANGETABLE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace openlcb {
+
+/// Event ID to target lookup for a set of 256 and 64K event blocks.
+///
+/// Events are grouped by their 64K block (the top 48 bits). Each block owns
+/// a 256 entry table indexed by bits 8-15 of the event ID, so resolving an
+/// event is two array lookups however many targets exist. update_ranges()
+/// computes the smallest set of aligned power-of-two ranges that covers
+/// exactly the claimed events, for registering with the event registry and
+/// for Range Identified replies; no range claims an event nobody consumes.
+///
+/// Has no knowledge of OpenMRN, so the host tools use the same code.
+template <unsigned MAX_TARGETS>
+class EventRangeTable {
+public:
+    using Index = typename std::conditional<(MAX_TARGETS < 0xFF), uint8_t, uint16_t>::type;
+    static constexpr Index NO_TARGET = (Index)~0;
+
+    struct Range {
+        uint64_t base;      // First event ID of the range
+        uint8_t bits;       // The range covers 2^bits events
+        Index block;        // Block holding its table
+    };
+
+    EventRangeTable() { clear(); }
+
+    void clear() {
+        numBlocks_ = 0;
+        numClaims_ = 0;
+        numRanges_ = 0;
+    }
+
+    /// Claim 2^bits events (8 or 16) starting at eventId for target. Returns
+    /// false if the table is full or the events are already claimed.
+    bool add(uint64_t eventId, unsigned bits, unsigned target) {
+        if (numClaims_ >= MAX_TARGETS || target >= MAX_TARGETS) return false;
+        uint64_t block = eventId & ~0xFFFFULL;
+        Block *b = find_block(block);
+        if (!b) {
+            if (numBlocks_ >= MAX_TARGETS) return false;
+            b = &blocks_[numBlocks_++];
+            b->block = block;
+            memset(b->slot, 0xFF, sizeof(b->slot));
+        }
+
+        unsigned first = bits >= 16 ? 0 : (eventId >> 8) & 0xFF;
+        unsigned count = bits >= 16 ? 256 : 1;
+        for (unsigned i = first; i < first + count; i++) {
+            if (b->slot[i] != NO_TARGET) return false;
+        }
+        for (unsigned i = first; i < first + count; i++) b->slot[i] = target;
+        numClaims_++;
+        return true;
+    }
+
+    /// Recompute the minimal aligned range cover of the claimed events
+    void update_ranges() {
+        numRanges_ = 0;
+        for (unsigned bi = 0; bi < numBlocks_; bi++) {
+            const Block &b = blocks_[bi];
+            // Greedy from the bottom: the largest aligned run of used slots
+            // starting at each gap-free position is part of a minimal cover
+            for (unsigned s = 0; s < 256;) {
+                if (b.slot[s] == NO_TARGET) {
+                    s++;
+                    continue;
+                }
+                unsigned k = 0;
+                while (k < 8 && (s & ((2U << k) - 1)) == 0 && used(b, s, 2U << k)) k++;
+                ranges_[numRanges_++] = {b.block | (uint64_t)s << 8, (uint8_t)(8 + k), (Index)bi};
+                s += 1U << k;
+            }
+        }
+    }
+
+    unsigned num_ranges() const { return numRanges_; }
+    const Range &range(unsigned i) const { return ranges_[i]; }
+
+    /// Event ID naming range i in a Range Identified message: the base with
+    /// the low bits all set, unless the bit above them is set (as OpenMRN's
+    /// EncodeRange)
+    uint64_t identifier(unsigned i) const {
+        uint64_t size = 1ULL << ranges_[i].bits;
+        return (ranges_[i].base & size) ? ranges_[i].base : ranges_[i].base | (size - 1);
+    }
+
+    /// Target of an event inside range i, or NO_TARGET
+    unsigned resolve(unsigned i, uint64_t event) const {
+        const Block &b = blocks_[ranges_[i].block];
+        if ((event & ~0xFFFFULL) != b.block) return NO_TARGET;
+        return b.slot[(event >> 8) & 0xFF];
+    }
+
+private:
+    struct Block {
+        uint64_t block;     // Event ID with the low 16 bits cleared
+        Index slot[256];    // Target per 256 event block, or NO_TARGET
+    };
+
+    Block *find_block(uint64_t block) {
+        for (unsigned i = 0; i < numBlocks_; i++) {
+            if (blocks_[i].block == block) return &blocks_[i];
+        }
+        return nullptr;
+    }
+
+    /// True if all count slots from first are claimed
+    static bool used(const Block &b, unsigned first, unsigned count) {
+        if (first + count > 256) return false;
+        for (unsigned i = first; i < first + count; i++) {
+            if (b.slot[i] == NO_TARGET) return false;
+        }
+        return true;
+    }
+
+    Block blocks_[MAX_TARGETS];
+    unsigned numBlocks_;
+    unsigned numClaims_;
+    // Every range starts at a different claim, so there are never more
+    // ranges than claims
+    Range ranges_[MAX_TARGETS];
+    unsigned numRanges_;
+};
+
+} // namespace openlcb
+
+#endif // __EVENTRANGETABLE_H
@@ -0,0 +1,166 @@
+#include "EventTrace.h"
+
+namespace openlcb {
+
+// ============================================================================
+// EventTrace Implementation
+// ============================================================================
+
+EventTrace::EventTrace()
+    : next_(0), dropped_(0), controller_(false), frozen_(false), frozenTime_(0),
+      dumpOffset_(-1), dumpEnd_(0) {
+}
+
+void EventTrace::record(bool sent, int channel, uint64_t event) {
+    OSMutexLock h(&lock_);
+    if (frozen_ && millis() - frozenTime_ >= FREEZE_TIMEOUT_MS) {
+        frozen_ = false;  // The reader gave up part way
+    }
+    if (frozen_) {
+        if (dropped_ < 0xFFFF) dropped_++;
+        return;
+    }
+    
+    // The oldest record is overwritten when full
+    Record &rec = records_[next_++ % CAPACITY];
+    rec.timeUs = micros();
+    rec.flags = (sent ? TRACE_FLAG_SENT : 0) | (uint8_t)((channel + 1) << TRACE_CHANNEL_SHIFT);
+    rec.event = event;
+}
+
+void EventTrace::set_controller(bool controller) {
+    OSMutexLock h(&lock_);
+    controller_ = controller;
+}
+
+void EventTrace::clear() {
+    OSMutexLock h(&lock_);
+    next_ = 0;
+    dropped_ = 0;
+    frozen_ = false;
+}
+
+uint16_t EventTrace::count() {
+    OSMutexLock h(&lock_);
+    return held();
+}
+
+size_t EventTrace::dump_size() {
+    OSMutexLock h(&lock_);
+    return HEADER_SIZE + held() * RECORD_SIZE;
+}
+
+void EventTrace::fill_header(uint8_t *header) {
+    uint16_t n = held();
+    memset(header, 0, HEADER_SIZE);
+    memcpy(header, TRACE_MAGIC, 4);
+    header[TRACE_VERSION_OFFSET] = TRACE_FORMAT_VERSION;
+    header[TRACE_RECORD_SIZE_OFFSET] = RECORD_SIZE;
+    header[TRACE_CAPACITY_OFFSET] = CAPACITY & 0xFF;
+    header[TRACE_CAPACITY_OFFSET + 1] = CAPACITY >> 8;
+    header[TRACE_COUNT_OFFSET] = n & 0xFF;
+    header[TRACE_COUNT_OFFSET + 1] = n >> 8;
+    header[TRACE_DROPPED_OFFSET] = dropped_ & 0xFF;
+    header[TRACE_DROPPED_OFFSET + 1] = dropped_ >> 8;
+    header[TRACE_FLAGS_OFFSET] = controller_ ? TRACE_HEADER_FLAG_CONTROLLER : 0;
+}
+
+size_t EventTrace::read(size_t offset, uint8_t *dst, size_t len) {
+    OSMutexLock h(&lock_);
+    if (frozen_ && millis() - frozenTime_ >= FREEZE_TIMEOUT_MS) {
+        frozen_ = false;  // An earlier reader gave up; start from a fresh view
+    }
+    size_t size = HEADER_SIZE + held() * RECORD_SIZE;
+    if (offset >= size) return 0;
+    if (len > size - offset) len = size - offset;
+
+    // Hold the records still until the reader reaches the end
+    frozen_ = true;
+    frozenTime_ = millis();
+
+    size_t copied = 0;
+    if (offset < HEADER_SIZE) {
+        uint8_t header[HEADER_SIZE];
+        fill_header(header);
+        size_t n = std::min(len, HEADER_SIZE - offset);
+        memcpy(dst, header + offset, n);
+        copied += n;
+    }
+
+    // Records are presented oldest first, unrolling the ring
+    uint32_t oldest = next_ > CAPACITY ? next_ % CAPACITY : 0;
+    while (copied < len) {
+        size_t pos = offset + copied - HEADER_SIZE;
+        size_t index = pos / RECORD_SIZE;
+        size_t within = pos % RECORD_SIZE;
+        const uint8_t *rec = (const uint8_t *)&records_[(oldest + index) % CAPACITY];
+        size_t n = std::min(len - copied, RECORD_SIZE - within);
+        memcpy(dst + copied, rec + within, n);
+        copied += n;
+    }
+
+    if (offset + len >= size) frozen_ = false;
+    return copied;
+}
+
+void EventTrace::poll_dump(Print &out) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    // "@T oooo " + hex bytes + newline
+    char line[8 + 2 * TRACE_LINE_BYTES + 1];
+    uint8_t chunk[TRACE_LINE_BYTES];
+
+    while (dumpOffset_ >= 0 && out.availableForWrite() >= (int)sizeof(line)) {
+        size_t n = 0;
+        if ((size_t)dumpOffset_ < dumpEnd_) {
+            n = read(dumpOffset_, chunk, std::min(sizeof(chunk), dumpEnd_ - dumpOffset_));
+        }
+        if (dumpOffset_ == 0 && n == HEADER_SIZE) {
+            // The header line comes first; stop at the end of the records it
+            // counts, not at records added once the trace is unfrozen
+            dumpEnd_ = HEADER_SIZE + (chunk[TRACE_COUNT_OFFSET] | chunk[TRACE_COUNT_OFFSET + 1] << 8) * RECORD_SIZE;
+        }
+        if (n == 0) {
+            out.write((const uint8_t *)"@T END\n", 7);
+            dumpOffset_ = -1;
+            return;
+        }
+        size_t pos = snprintf(line, sizeof(line), "@T %04lX ", (unsigned long)dumpOffset_);
+        for (size_t i = 0; i < n; i++) {
+            line[pos++] = HEX_DIGITS[chunk[i] >> 4];
+            line[pos++] = HEX_DIGITS[chunk[i] & 0x0F];
+        }
+        line[pos++] = '\n';
+        // One write per line, so log output can only land between lines
+        out.write((const uint8_t *)line, pos);
+        dumpOffset_ += n;
+    }
+}
+
+// ============================================================================
+// TraceMemorySpace Implementation
+// ============================================================================
+
+TraceMemorySpace::TraceMemorySpace(EventTrace *trace)
+    : trace_(trace) {
+}
+
+MemorySpace::address_t TraceMemorySpace::max_address() {
+    return trace_->dump_size() - 1;
+}
+
+size_t TraceMemorySpace::write(address_t destination, const uint8_t *data, size_t len,
+                               errorcode_t *error, Notifiable *again) {
+    trace_->clear();
+    return len;
+}
+
+size_t TraceMemorySpace::read(address_t source, uint8_t *dst, size_t len,
+                              errorcode_t *error, Notifiable *again) {
+    size_t n = trace_->read(source, dst, len);
+    if (n == 0) {
+        *error = MemoryConfigDefs::ERROR_OUT_OF_BOUNDS;
+    }
+    return n;
+}
+
+} // namespace openlcb
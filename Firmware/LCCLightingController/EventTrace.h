@@ -0,0 +1,107 @@
+#ifndef __EVENTTRACE_H
+#define __EVENTTRACE_H
+
+#include <Arduino.h>
+#include "openlcb/MemoryConfig.hxx"
+#include "os/OS.hxx"
+#include "TraceFormat.h"
+
+namespace openlcb {
+
+/// Memory space ID for reading the event trace over LCC
+static constexpr uint8_t TRACE_SPACE_ID = 0xA1;
+
+/// Ring buffer recorder of the channel events a strip sends and receives,
+/// read back in the dump format of TraceFormat.h.
+///
+/// Reading the dump freezes the trace so the records cannot change under the
+/// reader. Events arriving meanwhile are counted as dropped instead. The
+/// trace resumes once the last byte has been read, or FREEZE_TIMEOUT_MS
+/// after the latest read if the reader gives up.
+///
+/// Over serial the dump is sent as "@T" text lines, so it survives being
+/// interleaved with log output and can be cut out of a terminal capture.
+class EventTrace {
+public:
+    EventTrace();
+
+    /// Record an event on strip channel (-1 for other events). Safe to call
+    /// from the executor and loop threads.
+    void record(bool sent, int channel, uint64_t event);
+
+    /// Mark the trace as recorded on the controller (used by replays)
+    void set_controller(bool controller);
+
+    /// Discard all records
+    void clear();
+
+    /// Number of records currently held
+    uint16_t count();
+
+    /// Total size of the dump (header + records) in bytes
+    size_t dump_size();
+
+    /// Copy part of the dump starting at offset and freeze the trace until
+    /// the dump has been read to the end; returns bytes copied
+    size_t read(size_t offset, uint8_t *dst, size_t len);
+
+    /// Start sending the dump to a serial port from poll_dump()
+    void start_dump() { dumpOffset_ = 0; dumpEnd_ = HEADER_SIZE; }
+
+    /// Send the next dump lines that fit in the port's transmit buffer, so a
+    /// dump never blocks loop(). Call from loop().
+    void poll_dump(Print &out);
+
+    static constexpr uint16_t CAPACITY = 512;   // Records kept (~6.5KB)
+    static constexpr size_t HEADER_SIZE = TRACE_HEADER_SIZE;
+    static constexpr size_t RECORD_SIZE = TRACE_RECORD_SIZE;
+    static constexpr unsigned long FREEZE_TIMEOUT_MS = 5000;
+
+private:
+    struct __attribute__((packed)) Record {
+        uint32_t timeUs;
+        uint8_t flags;
+        uint64_t event;
+    };
+    static_assert(sizeof(Record) == RECORD_SIZE, "trace record must stay packed");
+
+    /// Fill the header as it appears at the start of the dump (lock held)
+    void fill_header(uint8_t *header);
+
+    /// Records held (lock held)
+    uint16_t held() { return next_ < CAPACITY ? next_ : CAPACITY; }
+
+    OSMutex lock_;                    // Guards everything below but dumpOffset_
+    Record records_[CAPACITY];
+    uint32_t next_;                   // Total records written since last clear
+    uint16_t dropped_;                // Events missed while frozen, since last clear
+    bool controller_;
+    bool frozen_;                     // A reader is part way through the dump
+    unsigned long frozenTime_;        // millis() of the latest read while frozen
+    long dumpOffset_;                 // Next serial dump byte (loop() only, -1 = idle)
+    size_t dumpEnd_;                  // Size of the dump being sent (loop() only)
+};
+
+/// View of an EventTrace as a memory configuration space. Reads return the
+/// dump format above; writing any byte clears the trace to start a new capture.
+class TraceMemorySpace : public MemorySpace {
+public:
+    TraceMemorySpace(EventTrace *trace);
+
+    bool read_only() override { return false; }
+
+    address_t max_address() override;
+
+    size_t write(address_t destination, const uint8_t *data, size_t len,
+                 errorcode_t *error, Notifiable *again) override;
+
+    size_t read(address_t source, uint8_t *dst, size_t len,
+                errorcode_t *error, Notifiable *again) override;
+
+private:
+    EventTrace *trace_;
+};
+
+} // namespace openlcb
+
+#endif // __EVENTTRACE_H
@@ -0,0 +1,56 @@
+#include "FrameBuffer.h"
+#include <string.h>
+#include "PowerLimiter.h"
+
+namespace openlcb {
+
+FrameBuffer::FrameBuffer()
+    : data_(nullptr), size_(0), sum_(0), uploading_(false) {
+}
+
+FrameBuffer::~FrameBuffer() {
+    delete[] data_;
+}
+
+bool FrameBuffer::resize(uint16_t ledCount) {
+    size_t size = (size_t)ledCount * BYTES_PER_PIXEL;
+    if (data_ && size == size_) return false;
+    delete[] data_;
+    size_ = size;
+    data_ = new uint8_t[size_]();
+    sum_ = 0;
+    uploading_ = false;
+    return true;
+}
+
+void FrameBuffer::start_frame() {
+    // Frames start from black, so the power estimate starts at zero
+    memset(data_, 0, size_);
+    sum_ = 0;
+    uploading_ = true;
+}
+
+size_t FrameBuffer::write(size_t offset, const uint8_t *data, size_t len) {
+    if (offset >= size_) return 0;
+    if (len > size_ - offset) len = size_ - offset;
+    if (!uploading_) start_frame();
+    // Keep the sum in step with the new bytes
+    sum_ += PowerLimiter::region_delta(data_ + offset, data, len);
+    memcpy(data_ + offset, data, len);
+    return len;
+}
+
+size_t FrameBuffer::read(size_t offset, uint8_t *dst, size_t len) const {
+    if (offset >= size_) return 0;
+    if (len > size_ - offset) len = size_ - offset;
+    memcpy(dst, data_ + offset, len);
+    return len;
+}
+
+uint32_t FrameBuffer::commit(uint8_t *dst) {
+    if (!uploading_) start_frame();
+    memcpy(dst, data_, size_);
+    return sum_;
+}
+
+} // namespace openlcb
@@ -0,0 +1,63 @@
+#ifndef __FRAMEBUFFER_H
+#define __FRAMEBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace openlcb {
+
+/// Pixel frame uploaded over LCC, waiting for its Frame Commit.
+///
+/// Holds one frame in wire order, BYTES_PER_PIXEL bytes per LED, as the
+/// pixel memory space exposes it. The first write after a scene starts a
+/// new frame from black; later writes change that frame in place until
+/// end_upload(). The byte sum is kept up to date with each write for the
+/// power estimate, so committing a frame needs no scan. Not thread safe
+/// (RGBWStrip calls it under its lock) and has no knowledge of the LEDs,
+/// so the host tools use the same code.
+class FrameBuffer {
+public:
+    static constexpr size_t BYTES_PER_PIXEL = 4;  // RGBW
+
+    FrameBuffer();
+    ~FrameBuffer();
+
+    /// Size the buffer for ledCount LEDs. Drops the frame if the size
+    /// changed; returns false if it did not.
+    bool resize(uint16_t ledCount);
+
+    /// Frame size in bytes
+    size_t size() const { return size_; }
+
+    /// Copy bytes into the frame at offset, starting a new frame first if
+    /// none is being uploaded. Returns the bytes written, clipped to the
+    /// end (0 if offset is past it).
+    size_t write(size_t offset, const uint8_t *data, size_t len);
+
+    /// Copy frame bytes at offset into dst; returns the bytes read
+    size_t read(size_t offset, uint8_t *dst, size_t len) const;
+
+    /// The strip left the uploaded frame (a fade started): the next write
+    /// starts a new frame
+    void end_upload() { uploading_ = false; }
+
+    /// Copy the frame to dst (size() bytes) for showing, black if nothing
+    /// was uploaded since end_upload(). Returns its byte sum.
+    uint32_t commit(uint8_t *dst);
+
+    /// Sum of the frame bytes
+    uint32_t sum() const { return sum_; }
+
+private:
+    /// Clear the frame for a new upload
+    void start_frame();
+
+    uint8_t *data_;
+    size_t size_;
+    uint32_t sum_;
+    bool uploading_;                   // data_ holds a frame started since end_upload()
+};
+
+} // namespace openlcb
+
+#endif // __FRAMEBUFFER_H
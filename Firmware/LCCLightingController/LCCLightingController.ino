@@ -4,11 +4,14 @@
 #include <OpenMRNLite.h>
 #include <Wire.h>
 #include <Adafruit_NeoPixel.h>
-#include <ADS1115_WE.h>
 
 #include "config.h"
 #include "NODEID.h"
 #include "RGBWStrip.h"
+#include "RGBWEventDispatcher.h"
+#include "AdcPanel.h"
+#include "PixelMemorySpace.h"
+#include "EventTrace.h"
 
 static constexpr openlcb::ConfigDef cfg(0);
 static constexpr uint8_t NUM_RGBW_STRIPS = openlcb::NUM_RGBW_STRIPS;
@@ -30,11 +33,13 @@ namespace openlcb {
   extern const char *const SNIP_DYNAMIC_FILENAME = CONFIG_FILENAME;
 }
 
-ADS1115_WE adc = ADS1115_WE();
 Esp32HardwareTwai twai(D8, D9);
 OpenMRN openmrn(NODE_ID);
 
+openlcb::AdcPanel *adcPanel = nullptr;
+openlcb::RGBWEventDispatcher *eventDispatcher = nullptr;
 openlcb::RGBWStrip *rgbwStrip = nullptr;
+openlcb::EventTrace eventTrace;
 bool isController = false;
 
 // Track when to start the fade animation
@@ -45,6 +50,7 @@ static bool fadeStarted = false;
 void setup() {
   Serial.begin(115200);
   Wire.begin();
+  Wire.setClock(400000);  // Fast mode keeps a 4-chip panel scan short
 
   delay(100);
 
@@ -85,35 +91,46 @@ void setup() {
     openlcb::CONFIG_FILE_SIZE);
   Serial.printf("Config check complete, fd=%d\n", config_fd);
 
-  // Initialize ADS1115 (controller only, but harmless if not populated)
-  if (!adc.init()) {
+  // Probe ADS1115 panel chips (controller only, but harmless if not populated)
+  adcPanel = new openlcb::AdcPanel(cfg.seg().adc_inputs());
+  if (adcPanel->begin() == 0) {
     isController = false;
     Serial.println("ADS1115 not detected - will run as FOLLOWER");
   } else {
     isController = true;
-    adc.setVoltageRange_mV(ADS1115_RANGE_4096);
-    adc.setCompareChannels(ADS1115_COMP_0_GND);
-    adc.setConvRate(ADS1115_250_SPS);
-    adc.setMeasureMode(ADS1115_CONTINUOUS);
-    Serial.println("ADS1115 detected - can run as CONTROLLER");
+    Serial.printf("%d ADS1115 detected - can run as CONTROLLER\n", adcPanel->num_chips());
   }
 
-  // Create RGBW strip controller and initialize if needed
+  // Create the node's event dispatcher, then the RGBW strip controller
+  eventDispatcher = new openlcb::RGBWEventDispatcher(openmrn.stack()->node());
   rgbwStrip = new openlcb::RGBWStrip(
     openmrn.stack()->node(),
     cfg.seg().rgbw_strips().entry(0),
-    &adc
+    adcPanel,
+    eventDispatcher
   );
   
   // Only reset RGBW config when config file is new or version changed
   if (needsFactoryReset) {
     Serial.println("Initializing RGBW config defaults...");
     rgbwStrip->factory_reset(config_fd);
+    adcPanel->factory_reset(config_fd);
     Serial.println("RGBW config initialized");
   } else {
     Serial.println("Config file valid, preserving user settings");
   };
 
+  // Expose the pixel buffer as a memory space for bulk frame uploads
+  openmrn.stack()->memory_config_handler()->registry()->insert(
+    openmrn.stack()->node(), openlcb::PIXEL_SPACE_ID,
+    new openlcb::PixelMemorySpace(rgbwStrip));
+
+  // Record channel events; read back over LCC or with 'T' on the serial port
+  rgbwStrip->set_trace(&eventTrace);
+  openmrn.stack()->memory_config_handler()->registry()->insert(
+    openmrn.stack()->node(), openlcb::TRACE_SPACE_ID,
+    new openlcb::TraceMemorySpace(&eventTrace));
+
   // Initialize OpenMRN stack
   openmrn.begin();
   openmrn.start_executor_thread();
@@ -125,6 +142,11 @@ void setup() {
   pinMode(LED_BUILTIN, OUTPUT);
   digitalWrite(LED_BUILTIN, LOW);
 
+  // Fades and show() run on their own task, so a long strip never delays
+  // the panel scan or the serial trace dump. The controller renders the
+  // events it sends through the same path as the followers.
+  rgbwStrip->start_render_task();
+
   Serial.println("=== Initialization Complete ===\n");
 }
 
@@ -136,11 +158,6 @@ void loop() {
     initCompleteTime = millis();
   }
 
-  // Follower: Poll fade animation (handles local high-fidelity fade)
-  if (!isController) {
-    rgbwStrip->poll_fade();
-  }
-
   // Controller: Start fade animation after configured delay (allows LCC bus to settle)
   if (isController && !fadeStarted) {
     unsigned long delayMs = rgbwStrip->startup_delay_sec() * 1000UL;
@@ -160,6 +177,19 @@ void loop() {
     }
   }
 
+  // Serial commands: 'T' dumps the event trace, 'C' clears it. The dump is
+  // sent a few lines per pass as the transmit buffer drains.
+  if (Serial.available()) {
+    int cmd = Serial.read();
+    if (cmd == 'T') {
+      eventTrace.start_dump();
+    } else if (cmd == 'C') {
+      eventTrace.clear();
+      Serial.println("Event trace cleared");
+    }
+  }
+  eventTrace.poll_dump(Serial);
+
   // Heartbeat LED
   static unsigned long lastBlink = 0;
   if (millis() - lastBlink >= 1000) {
@@ -0,0 +1,37 @@
+#include "PixelMemorySpace.h"
+
+namespace openlcb {
+
+PixelMemorySpace::PixelMemorySpace(RGBWStrip *strip)
+    : strip_(strip) {
+}
+
+MemorySpace::address_t PixelMemorySpace::max_address() {
+    size_t size = strip_->frame_size();
+    return size ? size - 1 : 0;
+}
+
+size_t PixelMemorySpace::write(address_t destination, const uint8_t *data, size_t len,
+                               errorcode_t *error, Notifiable *again) {
+    // Bounds are checked by the strip under its lock, since an LED count
+    // change reallocates the buffer. Writes stop fades and keep the power
+    // estimate in step with the new bytes.
+    size_t written = strip_->write_pixels(destination, data, len);
+    if (!written && len) {
+        *error = MemoryConfigDefs::ERROR_OUT_OF_BOUNDS;
+        return 0;
+    }
+    return written;
+}
+
+size_t PixelMemorySpace::read(address_t source, uint8_t *dst, size_t len,
+                              errorcode_t *error, Notifiable *again) {
+    size_t read = strip_->read_pixels(source, dst, len);
+    if (!read && len) {
+        *error = MemoryConfigDefs::ERROR_OUT_OF_BOUNDS;
+        return 0;
+    }
+    return read;
+}
+
+} // namespace openlcb
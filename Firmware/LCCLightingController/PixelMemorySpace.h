@@ -0,0 +1,38 @@
+#ifndef __PIXELMEMORYSPACE_H
+#define __PIXELMEMORYSPACE_H
+
+#include "openlcb/MemoryConfig.hxx"
+#include "RGBWStrip.h"
+
+namespace openlcb {
+
+/// Memory space ID for the raw pixel buffer (outside the 0xF8-0xFF range
+/// reserved by the standard)
+static constexpr uint8_t PIXEL_SPACE_ID = 0xA0;
+
+/// Memory configuration space mapped onto the strip's frame buffer.
+/// Address N is byte N of the strip buffer in wire order, 4 bytes per LED.
+/// Datagram writes land in the frame buffer; the strip's Frame Commit event
+/// then copies it to the LEDs from the render task, so the executor thread that
+/// serves this space never touches the NeoPixel buffer.
+class PixelMemorySpace : public MemorySpace {
+public:
+    PixelMemorySpace(RGBWStrip *strip);
+
+    bool read_only() override { return false; }
+
+    address_t max_address() override;
+
+    size_t write(address_t destination, const uint8_t *data, size_t len,
+                 errorcode_t *error, Notifiable *again) override;
+
+    size_t read(address_t source, uint8_t *dst, size_t len,
+                errorcode_t *error, Notifiable *again) override;
+
+private:
+    RGBWStrip *strip_;
+};
+
+} // namespace openlcb
+
+#endif // __PIXELMEMORYSPACE_H
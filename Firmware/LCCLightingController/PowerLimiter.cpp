@@ -0,0 +1,59 @@
+#include "PowerLimiter.h"
+
+namespace openlcb {
+
+PowerLimiter::PowerLimiter()
+    : sum_(0), ledCount_(0), budgetMa_(0), channelMa_(20), target_(255), limit_(255) {
+}
+
+void PowerLimiter::configure(uint16_t budgetMa, uint16_t channelMa) {
+    budgetMa_ = budgetMa;
+    channelMa_ = channelMa;
+}
+
+void PowerLimiter::on_fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    sum_ = (uint32_t)ledCount_ * ((uint32_t)r + g + b + w);
+}
+
+int32_t PowerLimiter::region_delta(const uint8_t *oldData, const uint8_t *newData, size_t len) {
+    int32_t delta = 0;
+    for (size_t i = 0; i < len; i++) {
+        delta += (int32_t)newData[i] - (int32_t)oldData[i];
+    }
+    return delta;
+}
+
+void PowerLimiter::scale(const uint8_t *src, uint8_t *dst, size_t len, uint8_t brightness) {
+    uint16_t factor = (uint16_t)brightness + 1;
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = (src[i] * factor) >> 8;
+    }
+}
+
+uint32_t PowerLimiter::estimate_ma(uint8_t brightness) {
+    return idle_ma() + (uint64_t)sum_ * channelMa_ * brightness / (255UL * 255UL);
+}
+
+uint8_t PowerLimiter::limit() {
+    target_ = 255;
+    uint32_t fullMa = estimate_ma(255);
+    if (budgetMa_ > 0 && fullMa > budgetMa_) {
+        // The quiescent current flows at any brightness; only the rest
+        // scales, so it comes off the budget first. scale() multiplies by
+        // (brightness + 1) / 256, so pick the cap with the same rounding.
+        uint32_t idleMa = idle_ma();
+        uint32_t factor = budgetMa_ > idleMa ? (budgetMa_ - idleMa) * 256 / (fullMa - idleMa) : 0;
+        target_ = factor > 0 ? factor - 1 : 0;
+    }
+
+    if (target_ < limit_) {
+        limit_ = target_;
+    } else if (target_ - limit_ > LIMIT_RISE_STEP) {
+        limit_ += LIMIT_RISE_STEP;
+    } else {
+        limit_ = target_;
+    }
+    return limit_;
+}
+
+} // namespace openlcb
@@ -0,0 +1,69 @@
+#ifndef __POWERLIMITER_H
+#define __POWERLIMITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace openlcb {
+
+/// Estimates strip current from the pixel buffer contents and caps the
+/// strip brightness to keep it within a supply budget.
+///
+/// The estimate is the quiescent current of the LEDs, which they draw even
+/// when dark, plus the sum of all channel bytes at full brightness scaled
+/// by the channel current. The sum is kept up to date incrementally: a
+/// solid fill sets it in O(1) and an uploaded frame carries a sum adjusted
+/// by the difference between the old and new bytes of each region write,
+/// so no per-frame scan is needed.
+class PowerLimiter {
+public:
+    PowerLimiter();
+
+    /// Set the current budget (0 = disabled) and per-channel LED current
+    void configure(uint16_t budgetMa, uint16_t channelMa);
+
+    /// Number of LEDs on the strip, for their quiescent current
+    void set_led_count(uint16_t count) { ledCount_ = count; }
+
+    /// Every pixel was set to the same colour at full brightness
+    void on_fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+
+    /// The buffer now holds contents whose channel bytes sum to sum
+    void set_sum(uint32_t sum) { sum_ = sum; }
+
+    /// Change in the channel byte sum when oldData is overwritten by newData
+    static int32_t region_delta(const uint8_t *oldData, const uint8_t *newData, size_t len);
+
+    /// Copy len bytes from src to dst scaled to brightness, rounding the
+    /// same way as Adafruit_NeoPixel::setBrightness()
+    static void scale(const uint8_t *src, uint8_t *dst, size_t len, uint8_t brightness);
+
+    /// Estimated strip current in mA at the given brightness
+    uint32_t estimate_ma(uint8_t brightness);
+
+    /// Current the LEDs draw at brightness 0 (WS2812 and SK6812 class
+    /// parts draw about 1 mA each for their driver)
+    uint32_t idle_ma() { return (uint32_t)ledCount_ * IDLE_MA_PER_LED; }
+
+    /// Brightness cap for the next frame. Drops at once when the budget is
+    /// exceeded and recovers a few steps per frame, so limiting is smooth.
+    uint8_t limit();
+    
+    /// True while the cap is still rising towards its target
+    bool recovering() { return limit_ < target_; }
+
+private:
+    static constexpr uint8_t LIMIT_RISE_STEP = 4;  // Cap recovery per frame
+    static constexpr uint16_t IDLE_MA_PER_LED = 1; // Quiescent current of one LED
+
+    uint32_t sum_;          // Sum of channel bytes at full brightness
+    uint16_t ledCount_;
+    uint16_t budgetMa_;
+    uint16_t channelMa_;    // Current of one channel at 255
+    uint8_t target_;        // Unsmoothed cap for the current contents
+    uint8_t limit_;         // Smoothed brightness cap
+};
+
+} // namespace openlcb
+
+#endif // __POWERLIMITER_H
@@ -32,11 +32,41 @@ CDI_GROUP_ENTRY(duration_event, openlcb::EventConfigEntry,
     Name("Transition Duration Event"),
     Description("Event ID base for fade duration (0-255 seconds). Triggers fade to pending RGBW+Brightness values. Must end in 00."));
 
+CDI_GROUP_ENTRY(stream_event, openlcb::EventConfigEntry,
+    Name("Streaming Fade Event"),
+    Description("Event ID base for slider streaming. Sent while a slider moves; triggers a short fade to pending RGBW+Brightness values. The high value byte is the fade time (x 10ms), the low byte the shared start time. Must end in 0000."));
+
+CDI_GROUP_ENTRY(timebase_event, openlcb::EventConfigEntry,
+    Name("Timebase Event"),
+    Description("Event ID base for the shared timebase (0-65535, units of 128 us). Controller broadcasts its clock periodically so followers can align fade start times. Must end in 0000."));
+
+CDI_GROUP_ENTRY(sync_duration_event, openlcb::EventConfigEntry,
+    Name("Synchronized Duration Event"),
+    Description("Event ID base for a Duration fade that starts at the same moment on every board. The high value byte is the fade time (0-255 seconds), the low byte the shared start time. Must end in 0000."));
+
+CDI_GROUP_ENTRY(frame_event, openlcb::EventConfigEntry,
+    Name("Frame Commit Event"),
+    Description("Event ID base for presenting a frame uploaded to the pixel memory space (0xA0). Any value in the range shows the frame. Must end in 00."));
+
+CDI_GROUP_ENTRY(epoch_event, openlcb::EventConfigEntry,
+    Name("Start Epoch Event"),
+    Description("Event ID base for the high byte of the shared start time. Sent right before every Streaming Fade and Synchronized Duration event, whose low byte completes it. Must end in 00."));
+
 CDI_GROUP_ENTRY(led_count, openlcb::Uint16ConfigEntry,
     Default(120), Min(1), Max(1000),
     Name("LED Count"),
     Description("Number of LEDs in the NeoPixel strip."));
 
+CDI_GROUP_ENTRY(current_budget, openlcb::Uint16ConfigEntry,
+    Default(0), Min(0), Max(30000),
+    Name("Current Budget (mA)"),
+    Description("Maximum current the strip may draw from its supply. Brightness is reduced smoothly whenever the estimated current of a frame exceeds it. Set to 0 to disable."));
+
+CDI_GROUP_ENTRY(channel_current, openlcb::Uint16ConfigEntry,
+    Default(20), Min(1), Max(100),
+    Name("LED Channel Current (mA)"),
+    Description("Current drawn by one color channel of one LED at full intensity, from the strip datasheet. Used to estimate frame current."));
+
 CDI_GROUP_ENTRY(sync_interval, openlcb::Uint16ConfigEntry,
     Default(3), Min(0), Max(60),
     Name("Sync Interval (seconds)"),
@@ -47,6 +77,11 @@ CDI_GROUP_ENTRY(startup_delay, openlcb::Uint16ConfigEntry,
     Name("Startup Delay (seconds)"),
     Description("Controller only: Delay before starting fade-in animation. Allows LCC bus to settle after power-on. Set to 0 to disable."));
 
+CDI_GROUP_ENTRY(stream_interval, openlcb::Uint16ConfigEntry,
+    Default(100), Min(0), Max(1000),
+    Name("Streaming Interval (ms)"),
+    Description("Controller only: Minimum time between slider updates. Each update is tagged with this interval as its fade time so followers glide between samples. Set to 0 to send raw values without a fade trigger."));
+
 CDI_GROUP_END();
 
 #endif // __RGBWCONFIG_H
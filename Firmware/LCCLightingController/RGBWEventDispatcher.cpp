@@ -0,0 +1,88 @@
+#include "RGBWEventDispatcher.h"
+
+namespace openlcb {
+
+RGBWEventDispatcher::RGBWEventDispatcher(Node *node)
+    : node_(node), registered_(false) {
+}
+
+RGBWEventDispatcher::~RGBWEventDispatcher() {
+    if (registered_) {
+        EventRegistry::instance()->unregister_handler(this);
+    }
+}
+
+bool RGBWEventDispatcher::add_channel(RGBWStrip *strip, int channel, uint64_t eventId) {
+    if (!channels_.add_channel(strip, channel, eventId)) {
+        Serial.printf("WARNING: Event 0x%016llX overlaps another channel, ignored\n", eventId);
+        return false;
+    }
+    return true;
+}
+
+void RGBWEventDispatcher::remove_strip(RGBWStrip *strip) {
+    channels_.remove_strip(strip);
+}
+
+void RGBWEventDispatcher::update_registration() {
+    if (registered_) {
+        EventRegistry::instance()->unregister_handler(this);
+        registered_ = false;
+    }
+
+    channels_.update_ranges();
+    for (unsigned i = 0; i < channels_.num_ranges(); i++) {
+        const auto &range = channels_.range(i);
+
+        // The mask parameter is the NUMBER OF BITS to mask, not a bitmask.
+        // user_arg carries the range index for O(1) lookup in the handlers.
+        EventRegistry::instance()->register_handler(
+            EventRegistryEntry(this, range.base, i), range.bits);
+        Serial.printf("Consumer range registered: 0x%016llX (%d bits)\n",
+                     range.base, range.bits);
+        registered_ = true;
+    }
+}
+
+void RGBWEventDispatcher::handle_event_report(const EventRegistryEntry &entry,
+                                              EventReport *event,
+                                              BarrierNotifiable *done) {
+    AutoNotify an(done);
+    
+    const auto *target = channels_.resolve(entry.user_arg, event->event);
+    if (target) {
+        target->strip->receive_event(target->channel, event->event);
+    }
+}
+
+void RGBWEventDispatcher::handle_identify_global(const EventRegistryEntry &entry,
+                                                 EventReport *event,
+                                                 BarrierNotifiable *done) {
+    // One Consumer Range Identified per registered range instead of one
+    // message per channel
+    if (node_->is_initialized()) {
+        event->event_write_helper<1>()->WriteAsync(
+            node_,
+            Defs::MTI_CONSUMER_IDENTIFIED_RANGE,
+            WriteHelper::global(),
+            eventid_to_buffer(channels_.identifier(entry.user_arg)),
+            done->new_child());
+    }
+    done->maybe_done();
+}
+
+void RGBWEventDispatcher::handle_identify_consumer(const EventRegistryEntry &entry,
+                                                   EventReport *event,
+                                                   BarrierNotifiable *done) {
+    if (channels_.resolve(entry.user_arg, event->event)) {
+        event->event_write_helper<1>()->WriteAsync(
+            node_,
+            Defs::MTI_CONSUMER_IDENTIFIED_VALID,
+            WriteHelper::global(),
+            eventid_to_buffer(event->event),
+            done->new_child());
+    }
+    done->maybe_done();
+}
+
+} // namespace openlcb
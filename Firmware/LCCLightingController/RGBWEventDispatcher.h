@@ -0,0 +1,54 @@
+#ifndef __RGBWEVENTDISPATCHER_H
+#define __RGBWEVENTDISPATCHER_H
+
+#include "openlcb/EventHandlerTemplates.hxx"
+#include "openlcb/EventHandler.hxx"
+#include "ChannelTable.h"
+#include "RGBWStrip.h"
+#include "config.h"
+
+namespace openlcb {
+
+/// Single event consumer per node for the channel events of all strips.
+///
+/// The channel events are kept in a ChannelTable, which registers the
+/// smallest set of aligned ranges covering exactly the channel events (so no
+/// range claims events another node consumes) and resolves an incoming event
+/// to its (strip, channel) with two array lookups no matter how many
+/// channels exist.
+class RGBWEventDispatcher : public SimpleEventHandler {
+public:
+    RGBWEventDispatcher(Node *node);
+    ~RGBWEventDispatcher();
+
+    /// Route the events of a strip channel to that strip. Takes effect at the
+    /// next update_registration(). Returns false if the table is full or the
+    /// events overlap a channel that was added earlier.
+    bool add_channel(RGBWStrip *strip, int channel, uint64_t eventId);
+
+    /// Remove all channels of a strip (before re-adding on config change)
+    void remove_strip(RGBWStrip *strip);
+
+    /// Re-register the minimal set of ranges with the event registry
+    void update_registration();
+
+    void handle_event_report(const EventRegistryEntry &entry, EventReport *event,
+                             BarrierNotifiable *done) override;
+
+    void handle_identify_global(const EventRegistryEntry &entry, EventReport *event,
+                                BarrierNotifiable *done) override;
+
+    void handle_identify_consumer(const EventRegistryEntry &entry, EventReport *event,
+                                  BarrierNotifiable *done) override;
+
+private:
+    static constexpr int MAX_TARGETS = NUM_CHANNELS * NUM_RGBW_STRIPS;
+
+    Node *node_;
+    ChannelTable<RGBWStrip, MAX_TARGETS> channels_;
+    bool registered_;
+};
+
+} // namespace openlcb
+
+#endif // __RGBWEVENTDISPATCHER_H
@@ -2,12 +2,18 @@
 #define __RGBWSTRIP_H
 
 #include <Adafruit_NeoPixel.h>
-#include <ADS1115_WE.h>
 #include "openlcb/EventHandlerTemplates.hxx"
 #include "openlcb/EventHandler.hxx"
 #include "openlcb/Convert.hxx"
+#include "os/OS.hxx"
 #include "utils/ConfigUpdateListener.hxx"
 #include "RGBWConfig.h"
+#include "EventTrace.h"
+#include "AdcPanel.h"
+#include "SceneEngine.h"
+#include "SceneBroadcaster.h"
+#include "FrameBuffer.h"
+#include "StripRenderer.h"
 
 // Hardware configuration - NeoPixel GPIO pin on PCB
 #define NEOPIXEL_PIN D10
@@ -15,34 +21,13 @@
 namespace openlcb {
 
 /// Forward declaration
-class RGBWStrip;
-
-/// Event consumer for receiving RGBW channel updates from controller devices
-class RGBWEventHandler : public SimpleEventHandler {
-public:
-    RGBWEventHandler(RGBWStrip *parent, int channel);
-    
-    /// Handle incoming channel value event
-    void handle_event_report(const EventRegistryEntry &entry, EventReport *event,
-                             BarrierNotifiable *done) override;
-    
-    void handle_identify_global(const EventRegistryEntry &entry, EventReport *event,
-                                BarrierNotifiable *done) override;
-    
-    void handle_identify_consumer(const EventRegistryEntry &entry, EventReport *event,
-                                   BarrierNotifiable *done) override;
-    
-    uint64_t base_event_id() const;
-    
-private:
-    RGBWStrip *parent_;
-    int channel_;  // 0=Red, 1=Green, 2=Blue, 3=White, 4=Brightness, 5=Duration
-};
+class RGBWEventDispatcher;
 
 /// Main RGBW strip controller
-class RGBWStrip : public DefaultConfigUpdateListener {
+class RGBWStrip : public DefaultConfigUpdateListener, public SceneBroadcaster::Sink {
 public:
-    RGBWStrip(Node *node, const RGBWConfig &cfg, ADS1115_WE *adc);
+    RGBWStrip(Node *node, const RGBWConfig &cfg, AdcPanel *panel,
+              RGBWEventDispatcher *dispatcher);
     ~RGBWStrip();
 
     UpdateAction apply_configuration(int fd, bool initial_load, 
@@ -50,7 +35,7 @@ public:
     
     void factory_reset(int fd) OVERRIDE;
 
-    /// Controller: Poll ADC channels and send events if changed
+    /// Controller: Poll panel inputs and send events if changed
     void poll_adc_inputs();
 
     /// Controller: Run startup animation (fade from black to target colors)
@@ -59,88 +44,115 @@ public:
     /// Controller: Non-blocking startup animation state machine
     void poll_startup_animation();
 
-    /// Follower: Handle incoming channel value event
-    void handle_channel_event(int channel, uint8_t value);
+    /// Follower: Handle an incoming event resolved to one of our channels
+    void receive_event(int channel, uint64_t event);
 
-    /// Controller: Send individual channel event
-    void send_channel_event(int channel, uint8_t value);
+    /// Handle a channel value event (received, or looped back on the controller)
+    void handle_channel_event(int channel, uint16_t value);
+
+    /// Controller: Send individual channel event and loop it back locally
+    void send_channel_event(int channel, uint16_t value) override;
     
-    /// Flush pending strip updates (rate-limited)
+    /// Show pending strip updates (rate-limited)
     void flush_strip();
     
-    /// Poll fade interpolation - call from loop() at ~60-100Hz
-    /// Handles local high-fidelity fade animation
+    /// Poll fade interpolation and show the strip. Runs on the render task;
+    /// handles local high-fidelity fade animation on controller and followers
     void poll_fade();
+    
+    /// Start the render task, which runs poll_fade() on its own so show()
+    /// (about 40 ms for 1000 LEDs) never holds up loop() and the panel scan
+    void start_render_task();
 
     /// Get node pointer
     Node* node() { return node_; }
     
-    /// Get event ID for specific channel (0-5: R, G, B, W, Brightness, Duration)
+    /// Get event ID for specific channel (0-10: R, G, B, W, Brightness, Duration, Stream,
+    /// Timebase, Synchronized Duration, Frame, Start Epoch)
     uint64_t event_id(int channel) { return eventIds_[channel]; }
     
     /// Get startup delay in seconds (controller only)
     uint16_t startup_delay_sec() { return startupDelaySec_; }
+    
+    /// Size of the frame upload buffer in bytes (wire order, 4 bytes per LED)
+    size_t frame_size();
+    
+    /// Copy uploaded frame bytes into the frame buffer at offset and stop
+    /// fades. Safe to call from the executor; the strip itself only changes
+    /// when the render task handles a Frame Commit. Returns the bytes written
+    /// (0 if offset is past the end).
+    size_t write_pixels(size_t offset, const uint8_t *data, size_t len);
+    
+    /// Copy frame buffer bytes at offset into dst; returns the bytes read
+    size_t read_pixels(size_t offset, uint8_t *dst, size_t len);
+    
+    /// Record sent and received channel events into this trace (nullptr = off)
+    void set_trace(EventTrace *trace) { trace_ = trace; }
+    
+    static constexpr size_t BYTES_PER_PIXEL = FrameBuffer::BYTES_PER_PIXEL;
 
 private:
-    void update_strip(uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+    /// Send a fully encoded event ID as a global event report. channel is
+    /// the strip channel it encodes, or -1, for the trace.
+    void send_event(uint64_t event, int channel);
+    
+    /// Our 8-bit channel (0-5, 9, 10) whose event base matches eventId, or -1
+    int local_channel(uint64_t eventId);
+    
+    /// Log the fade just started by a Duration event
+    void log_fade(uint8_t seconds);
+    
+    /// (Re)create the NeoPixel strip for ledCount_ LEDs (render task, lock held)
+    void resize_strip();
+    
+    /// Render task body: poll_fade() once per tick
+    static void render_task(void *arg);
 
     Node *node_;
     const RGBWConfig cfg_;
-    ADS1115_WE *adc_;
+    AdcPanel *panel_;
+    RGBWEventDispatcher *dispatcher_;
     Adafruit_NeoPixel *strip_;
     
     bool isController_;
-    uint64_t eventIds_[6];  // Event IDs: [R, G, B, W, Brightness, Duration]
-    
-    // Current actual values (what LEDs are showing right now)
-    uint8_t currentR_, currentG_, currentB_, currentW_;
-    uint8_t currentBrightness_;
-    
-    // Pending values (received via LCC, waiting for duration event to trigger fade)
-    uint8_t pendingR_, pendingG_, pendingB_, pendingW_;
-    uint8_t pendingBrightness_;
-    
-    // Fade interpolation state
-    bool fadeInProgress_;
-    unsigned long fadeStartTime_;      // millis() when fade started
-    unsigned long fadeDurationMs_;     // Total fade duration in ms
-    uint8_t fadeStartR_, fadeStartG_, fadeStartB_, fadeStartW_;
-    uint8_t fadeStartBrightness_;
-    uint8_t fadeTargetR_, fadeTargetG_, fadeTargetB_, fadeTargetW_;
-    uint8_t fadeTargetBrightness_;
-    
-    // For controller sending (last sent values)
-    uint8_t lastSentR_, lastSentG_, lastSentB_, lastSentW_, lastSentBrightness_;
-    
-    uint8_t adcChannelIndex_;
-    unsigned long lastEventSendTime_;  // Rate limiting for CAN bus
+    uint64_t eventIds_[NUM_CHANNELS];  // Event IDs: [R, G, B, W, Brightness, Duration, Stream, Timebase, Sync Duration, Frame, Epoch]
+    
+    SceneEngine engine_;               // Pending values, fades and shared timebase
+    
+    // Controller: what to send for the panel values, and when (the strip
+    // shows what was sent, through the loopback)
+    SceneBroadcaster broadcaster_;
+    
+    uint16_t inputsToSend_;            // Panel inputs mapped to non-local events awaiting send
     bool startupAnimationComplete_;    // Track if startup fade-in is done
     
-    // NeoPixel rate limiting (minimum ~16ms between show() calls = 60fps)
-    static constexpr unsigned long MIN_SHOW_INTERVAL_MS = 16;
-    static constexpr uint8_t ANIM_BRIGHTNESS_STEP = 2;  // Brightness increment per animation frame
+    static constexpr uint8_t ANIM_FADE_SEC = 5;         // Startup fade-in duration
     static constexpr uint16_t DEFAULT_LED_COUNT = 120;  // Default LED count if config invalid
-    unsigned long lastShowTime_;       // Last time show() was called
-    bool stripDirty_;                  // True if strip needs updating
+    static constexpr uint32_t RENDER_STACK_SIZE = 4096;  // Render task stack (bytes)
+    static constexpr unsigned RENDER_PRIORITY = 1;      // Same as loop()
+    static constexpr int RENDER_CORE = 0;               // loop() runs on core 1 of a dual-core ESP32
+    StripRenderer renderer_;           // Scene or frame, power limit and show pacing (render task only)
     
     // Startup animation state machine
-    enum AnimationState { ANIM_IDLE, ANIM_READ_ADC, ANIM_SEND_COLORS, ANIM_FADE_BRIGHTNESS };
+    enum AnimationState { ANIM_IDLE, ANIM_READ_ADC, ANIM_SEND_COLORS };
     AnimationState animState_;
-    uint8_t animTargetR_, animTargetG_, animTargetB_, animTargetW_;
-    uint8_t animBrightness_;          // Current brightness during fade animation
-    unsigned long animLastUpdate_;
     int animStep_;
     
-    // Periodic sync for controller
-    uint16_t syncIntervalSec_;        // Sync interval in seconds (0 = disabled)
-    unsigned long lastSyncTime_;       // Last time we sent a full sync
-    int syncStep_;                     // Current step in sync sequence (-1 = idle)
-    unsigned long lastSyncStepTime_;   // Time of last sync step
     uint16_t startupDelaySec_;        // Startup delay before fade animation
     
-    RGBWEventHandler *eventHandlers_[6];  // One handler per channel (R,G,B,W,Br,Dur)
-    
-    friend class RGBWEventHandler;
+    EventTrace *trace_;               // Optional event recorder
+    
+    // Shared between the executor (events, memory space, configuration),
+    // loop() (the panel and the events it loops back) and the render task.
+    // Only the render task touches strip_ and calls show(); the others work
+    // on the fade engine and the frame buffer, under lock_.
+    OSMutex lock_;                     // Guards engine_ and the members below
+    uint16_t ledCount_;                // Configured LED count; the render task resizes strip_ to it
+    FrameBuffer frame_;                // Uploaded frame, copied to the strip on commit
+    bool frameCommitPending_;          // Frame Commit received, show it from the render task
+    uint16_t budgetMa_;                // Power limit settings for the renderer
+    uint16_t channelMa_;
+    bool powerConfigPending_;          // Settings changed, the render task applies them
 };
 
 } // namespace openlcb
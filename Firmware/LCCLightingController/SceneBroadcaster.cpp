@@ -0,0 +1,147 @@
+#include "SceneBroadcaster.h"
+
+namespace openlcb {
+
+SceneBroadcaster::SceneBroadcaster(Sink *sink)
+    : sink_(sink), syncIntervalSec_(3), streamIntervalMs_(100),
+      input_{0, 0, 0, 0, 255}, sent_{0, 0, 0, 0, 255},
+      durationPending_(false), durationSec_(0), lastSendMs_(0),
+      fadeInStep_(-1), fadeInValues_{0, 0, 0, 0, 255}, fadeInSec_(0), lastFadeInMs_(0),
+      syncStep_(-1), lastSyncMs_(0), lastSyncStepMs_(0), lastTimebaseMs_(0) {
+}
+
+void SceneBroadcaster::configure(uint16_t syncIntervalSec, uint16_t streamIntervalMs) {
+    syncIntervalSec_ = syncIntervalSec;
+    streamIntervalMs_ = streamIntervalMs;
+}
+
+void SceneBroadcaster::request_duration(uint8_t seconds) {
+    durationPending_ = true;
+    durationSec_ = seconds;
+}
+
+void SceneBroadcaster::start_fade_in(const uint8_t values[SCENE_CHANNELS], uint8_t seconds) {
+    for (int c = 0; c < SCENE_CHANNELS; c++) fadeInValues_[c] = values[c];
+    fadeInSec_ = seconds;
+    fadeInStep_ = 0;
+}
+
+bool SceneBroadcaster::send_due(unsigned long nowMs) const {
+    unsigned long intervalMs = streamIntervalMs_ > 0 ? streamIntervalMs_ : LEGACY_SEND_INTERVAL_MS;
+    return nowMs - lastSendMs_ >= intervalMs;
+}
+
+bool SceneBroadcaster::poll(unsigned long nowMs, unsigned long nowUs) {
+    if (fading_in()) {
+        poll_fade_in(nowMs, nowUs);
+        return false;
+    }
+
+    // Send the channels that differ from what followers last saw (rate
+    // limited to prevent CAN bus flooding). Checked on every poll so the
+    // final position of a slider is always sent, even if it stopped moving
+    // inside the rate limit window.
+    bool sentValues = false;
+    if (send_due(nowMs)) {
+        for (int c = 0; c < SCENE_CHANNELS; c++) {
+            if (input_[c] == sent_[c]) continue;
+            sink_->send_channel_event(c, input_[c]);
+            sent_[c] = input_[c];
+            sentValues = true;
+        }
+        if (durationPending_) {
+            // After the values, so the fade goes to the values just sent; it
+            // replaces the Stream fade, so no Stream trigger is needed
+            send_synchronized_duration(nowUs, durationSec_);
+            durationPending_ = false;
+            lastSendMs_ = nowMs;
+        } else if (sentValues && streamIntervalMs_ > 0) {
+            // Streaming: tag the burst with a fade time equal to the send
+            // interval, so followers glide to these values just as the next
+            // sample is due instead of waiting for a Duration event. The
+            // shared start time lets every follower begin together.
+            send_fade_trigger(6, streamIntervalMs_ / SceneEngine::STREAM_FADE_UNIT_MS,
+                              SceneEngine::timebase_units(nowUs + SceneEngine::FADE_START_LEAD_MS * 1000));
+        }
+        if (sentValues) lastSendMs_ = nowMs;
+    }
+
+    // Periodic sync for followers that missed an event, one channel every
+    // SYNC_STEP_MS
+    if (syncIntervalSec_ > 0) {
+        if (syncStep_ < 0 && nowMs - lastSyncMs_ >= syncIntervalSec_ * 1000UL) {
+            syncStep_ = 0;
+            lastSyncStepMs_ = nowMs;
+        }
+        if (syncStep_ >= 0 && nowMs - lastSyncStepMs_ >= SYNC_STEP_MS) {
+            sink_->send_channel_event(syncStep_, input_[syncStep_]);
+            lastSyncStepMs_ = nowMs;
+            if (++syncStep_ >= SCENE_CHANNELS) {
+                syncStep_ = -1;
+                lastSyncMs_ = nowMs;
+            }
+        }
+    }
+
+    // Broadcast our clock so followers can align scheduled fade starts
+    if (nowMs - lastTimebaseMs_ >= TIMEBASE_INTERVAL_MS) send_timebase(nowMs, nowUs);
+    return sentValues;
+}
+
+void SceneBroadcaster::poll_fade_in(unsigned long nowMs, unsigned long nowUs) {
+    // One event at a time: a burst of timebase samples, black instantly,
+    // then the colors and a fade up to the target brightness. Both fades
+    // carry a shared start time so every board runs them together; the
+    // local strip renders them from the loopback exactly like every
+    // follower does.
+    const int burst = SceneEngine::TIMEBASE_BURST;
+    unsigned long stepMs = fadeInStep_ > 0 && fadeInStep_ < burst ?
+                           SceneEngine::TIMEBASE_BURST_INTERVAL_MS : FADE_IN_STEP_MS;
+    if (nowMs - lastFadeInMs_ < stepMs) return;
+
+    if (fadeInStep_ < burst) {
+        send_timebase(nowMs, nowUs);
+    } else {
+        int step = fadeInStep_ - burst;
+        switch (step) {
+            case 0: sink_->send_channel_event(4, 0); break;
+            case 1: send_synchronized_duration(nowUs, 0); break;
+            case 7: send_synchronized_duration(nowUs, fadeInSec_); break;
+            default: sink_->send_channel_event(step - 2, fadeInValues_[step - 2]); break;  // R, G, B, W, Br
+        }
+    }
+    lastFadeInMs_ = nowMs;
+
+    if (++fadeInStep_ >= burst + 8) {
+        // Fade-in sent: the panel state now matches what followers saw
+        for (int c = 0; c < SCENE_CHANNELS; c++) input_[c] = sent_[c] = fadeInValues_[c];
+        fadeInStep_ = -1;
+    }
+}
+
+void SceneBroadcaster::send_timebase(unsigned long nowMs, unsigned long nowUs) {
+    sink_->send_channel_event(7, SceneEngine::timebase_units(nowUs));
+    lastTimebaseMs_ = nowMs;
+}
+
+void SceneBroadcaster::send_fade_trigger(int channel, uint8_t high, uint16_t start) {
+    // The trigger only has room for the low byte of the start time; the
+    // epoch ahead of it carries the high byte, so followers can place a
+    // trigger held up on the bus for seconds
+    sink_->send_channel_event(10, start >> 8);
+    sink_->send_channel_event(channel, (uint16_t)high << 8 | (start & 0xFF));
+}
+
+void SceneBroadcaster::send_synchronized_duration(unsigned long nowUs, uint8_t seconds) {
+    send_fade_trigger(8, seconds, SceneEngine::timebase_units(nowUs + SceneEngine::FADE_START_LEAD_MS * 1000));
+}
+
+void SceneBroadcaster::relay_duration(unsigned long receivedUs, uint8_t seconds) {
+    // The Duration event started on receipt on every board. The frame
+    // reached all of them at the same moment, so relaying our receipt time
+    // lets each board move its fade start to that instant, removing its own
+    // processing delay.
+    send_fade_trigger(8, seconds, SceneEngine::timebase_units(receivedUs));
+}
+
+} // namespace openlcb
@@ -0,0 +1,110 @@
+#ifndef __SCENEBROADCASTER_H
+#define __SCENEBROADCASTER_H
+
+#include <stdint.h>
+#include "SceneEngine.h"
+
+namespace openlcb {
+
+/// Controller side of the scene protocol: which channel events go out, and
+/// when.
+///
+/// Sends changed panel values (rate limited, tagged with a Stream trigger),
+/// synchronized Duration fades, the periodic resync, the timebase broadcast
+/// and the startup fade-in. The events go out through a Sink, which also
+/// loops them back into the local SceneEngine. Like SceneEngine it has no
+/// knowledge of the bus and takes the time as parameters (millis() for the
+/// send schedule, micros() for start times), so the host simulations run
+/// the same code as the board.
+class SceneBroadcaster {
+public:
+    /// Receives the channel events to send
+    class Sink {
+    public:
+        /// Send a channel event and loop it back into the local engine
+        virtual void send_channel_event(int channel, uint16_t value) = 0;
+    };
+
+    /// Scene channels: R, G, B, W, Brightness
+    static constexpr int SCENE_CHANNELS = 5;
+
+    explicit SceneBroadcaster(Sink *sink);
+
+    /// Periodic resync interval in seconds and Streaming Interval in ms
+    /// (0 = off for either)
+    void configure(uint16_t syncIntervalSec, uint16_t streamIntervalMs);
+
+    /// Latest panel value of a scene channel, sent by poll() when it changed
+    void set_input(int channel, uint8_t value) { input_[channel] = value; }
+    uint8_t input(int channel) const { return input_[channel]; }
+
+    /// Send a synchronized Duration fade of seconds with the next values
+    void request_duration(uint8_t seconds);
+
+    /// Send the startup fade-in over the following polls: a burst of
+    /// timebase samples, black, then a synchronized fade up to values
+    void start_fade_in(const uint8_t values[SCENE_CHANNELS], uint8_t seconds);
+
+    /// True until the fade-in has been sent
+    bool fading_in() const { return fadeInStep_ >= 0; }
+
+    /// True if the rate limit lets poll() send values now
+    bool send_due(unsigned long nowMs) const;
+
+    /// Restart the rate limit after sending other events in the window
+    void sent(unsigned long nowMs) { lastSendMs_ = nowMs; }
+
+    /// Send whatever is due. Returns true if changed values went out.
+    bool poll(unsigned long nowMs, unsigned long nowUs);
+
+    /// Send a Duration fade that starts at the same moment on every board
+    void send_synchronized_duration(unsigned long nowUs, uint8_t seconds);
+
+    /// Relay a Duration event from another producer, received at receivedUs,
+    /// as a Synchronized Duration starting at that instant
+    void relay_duration(unsigned long receivedUs, uint8_t seconds);
+
+    /// Slider send interval when streaming is off
+    static constexpr unsigned long LEGACY_SEND_INTERVAL_MS = 50;
+    /// Controller clock broadcast period
+    static constexpr unsigned long TIMEBASE_INTERVAL_MS = 1000;
+    /// Spacing of the periodic resync channels
+    static constexpr unsigned long SYNC_STEP_MS = 20;
+    /// Spacing of the fade-in events after the timebase burst
+    static constexpr unsigned long FADE_IN_STEP_MS = 10;
+
+private:
+    /// Send a Start Epoch with the high byte of start, then the trigger
+    /// channel (Stream or Synchronized Duration) with high in its high byte
+    /// and the low byte of start
+    void send_fade_trigger(int channel, uint8_t high, uint16_t start);
+
+    void send_timebase(unsigned long nowMs, unsigned long nowUs);
+
+    /// Send the next fade-in event if it is due
+    void poll_fade_in(unsigned long nowMs, unsigned long nowUs);
+
+    Sink *sink_;
+    uint16_t syncIntervalSec_;
+    uint16_t streamIntervalMs_;
+
+    uint8_t input_[SCENE_CHANNELS];    // Latest panel values
+    uint8_t sent_[SCENE_CHANNELS];     // Values the followers last saw
+    bool durationPending_;
+    uint8_t durationSec_;
+    unsigned long lastSendMs_;
+
+    int fadeInStep_;                   // Next fade-in event (-1 = idle)
+    uint8_t fadeInValues_[SCENE_CHANNELS];
+    uint8_t fadeInSec_;
+    unsigned long lastFadeInMs_;
+
+    int syncStep_;                     // Next resync channel (-1 = idle)
+    unsigned long lastSyncMs_;
+    unsigned long lastSyncStepMs_;
+    unsigned long lastTimebaseMs_;
+};
+
+} // namespace openlcb
+
+#endif // __SCENEBROADCASTER_H
@@ -0,0 +1,268 @@
+#include "SceneEngine.h"
+
+namespace openlcb {
+
+/// Signed difference of two times mod the timebase span
+static long span_delta(uint32_t diff) {
+    diff &= SceneEngine::TIMEBASE_SPAN_US - 1;
+    return diff >= SceneEngine::TIMEBASE_SPAN_US / 2 ? (long)diff - (long)SceneEngine::TIMEBASE_SPAN_US
+                                                      : (long)diff;
+}
+
+SceneEngine::SceneEngine()
+    : current_{0, 0, 0, 0, 255}, pending_{0, 0, 0, 0, 255},
+      fadeInProgress_(false), fadeStream_(false), finished_(false), redraw_(false),
+      fadeStartTime_(0), fadeDurationMs_(0),
+      fadeStart_{0, 0, 0, 0, 255}, fadeTarget_{0, 0, 0, 0, 255},
+      fadeScheduled_(false), schedStream_(false), schedStartTime_(0), schedDurationMs_(0),
+      schedTarget_{0, 0, 0, 0, 255}, epochValid_(false), epoch_(0),
+      timebaseSource_(false), timebaseCount_(0), timebaseIndex_(0), timebaseBurst_(false),
+      timebaseOffset_(0),
+      lastTimebaseTime_(0) {
+}
+
+void SceneEngine::channel_event(unsigned long nowUs, int channel, uint16_t value) {
+    switch (channel) {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+            set_pending(channel, value);
+            break;
+        case 5:
+            // Duration event triggers the fade on receipt (seconds, 0 = instant)
+            start_fade(nowUs, (unsigned long)value * 1000UL, false);
+            break;
+        case 6:
+            // Stream event: short fade (10ms units, high byte) towards the
+            // latest slider sample, starting at the shared time in the low
+            // byte. Restarting from the current interpolated values keeps the
+            // motion continuous while the next sample is in flight.
+            trigger(nowUs, value & 0xFF, (unsigned long)(value >> 8) * STREAM_FADE_UNIT_MS, true);
+            break;
+        case 7:
+            timebase_sample(nowUs, value);
+            break;
+        case 8:
+            // Synchronized Duration: seconds in the high byte, start time in
+            // the controller clock in the low byte
+            trigger(nowUs, value & 0xFF, (unsigned long)(value >> 8) * 1000UL, false);
+            break;
+        case 9:
+            // Frame commit: an uploaded frame replaces the scene
+            stop();
+            break;
+        case 10:
+            // Start Epoch: high byte of the next trigger's start time
+            epoch_ = value;
+            epochValid_ = true;
+            break;
+    }
+}
+
+void SceneEngine::trigger(unsigned long nowUs, uint8_t startLow,
+                          unsigned long durationMs, bool stream) {
+    // The controller sends the epoch right before every trigger, and CAN
+    // keeps one sender's frames in order. Without it (missed, or a producer
+    // that does not send one) the start time is unknown.
+    if (!epochValid_) {
+        start_fade(nowUs, durationMs, stream);
+        return;
+    }
+    epochValid_ = false;
+    start_fade_at(nowUs, (uint16_t)epoch_ << 8 | startLow, durationMs, stream);
+}
+
+void SceneEngine::set_pending(int channel, uint8_t value) {
+    switch (channel) {
+        case 0: pending_.r = value; break;
+        case 1: pending_.g = value; break;
+        case 2: pending_.b = value; break;
+        case 3: pending_.w = value; break;
+        case 4: pending_.brightness = value; break;
+    }
+}
+
+void SceneEngine::start_fade(unsigned long nowUs, unsigned long durationMs, bool stream) {
+    fadeScheduled_ = false;
+    begin_fade(nowUs, durationMs, stream, pending_);
+}
+
+void SceneEngine::start_fade_at(unsigned long nowUs, uint16_t remoteStart,
+                                unsigned long durationMs, bool stream) {
+    if (!timebase_valid(nowUs)) {
+        start_fade(nowUs, durationMs, stream);
+        return;
+    }
+    unsigned long startTime = local_start(nowUs, remoteStart);
+
+    // The same fade already started on receipt (a Duration event relayed by
+    // the controller with its receipt time): only move its start so every
+    // board runs it from the same instant
+    if (fadeInProgress_ && !fadeStream_ && !stream && fadeTarget_ == pending_ &&
+        fadeDurationMs_ == durationMs && nowUs - fadeStartTime_ < RETIME_WINDOW_US) {
+        fadeStartTime_ = startTime;
+        return;
+    }
+
+    if ((long)(startTime - nowUs) > 0) {
+        // Start time is still ahead: arm the fade and let the current one
+        // keep running until then, so the hand-over has no jump
+        fadeScheduled_ = true;
+        schedStartTime_ = startTime;
+        schedDurationMs_ = durationMs;
+        schedStream_ = stream;
+        schedTarget_ = pending_;
+        return;
+    }
+    // Start time already passed (late delivery): start in the past so this
+    // strip catches up with the others instead of lagging behind
+    fadeScheduled_ = false;
+    begin_fade(startTime, durationMs, stream, pending_);
+}
+
+unsigned long SceneEngine::local_start(unsigned long nowUs, uint16_t remoteStart) {
+    // The start wraps with the 16-bit timebase; start times are always near
+    // the present, so take the one in [now - PAST, now + SPAN - PAST]
+    uint32_t remoteNow = (uint32_t)nowUs - timebaseOffset_;
+    uint32_t ahead = ((uint32_t)remoteStart << TIMEBASE_UNIT_SHIFT) - remoteNow + START_WINDOW_PAST_US;
+    long delta = (long)(ahead & (TIMEBASE_SPAN_US - 1)) - (long)START_WINDOW_PAST_US;
+    return nowUs + delta;
+}
+
+void SceneEngine::begin_fade(unsigned long startTime, unsigned long durationMs, bool stream,
+                             const SceneValues &target) {
+    // Capture current actual values as fade start
+    fadeStart_ = current_;
+    fadeTarget_ = target;
+    fadeDurationMs_ = durationMs;
+    fadeStartTime_ = startTime;
+    fadeStream_ = stream;
+    finished_ = false;
+    redraw_ = true;
+    // Instant applies (duration 0) complete on the next poll()
+    fadeInProgress_ = true;
+}
+
+void SceneEngine::timebase_sample(unsigned long nowUs, uint16_t remote) {
+    if (timebaseSource_) return;
+
+    // Every sample is (true offset + delivery delay). CAN frames reach all
+    // followers at the same moment, so the smallest recent sample is the best
+    // estimate of the offset and is common to every board on the segment.
+    // The frame's bus time and the fastest hand-off are the part of the
+    // delay that never goes away.
+    // The controller stamps its clock rounded down to a whole unit, so on
+    // average it read half a unit more.
+    uint32_t remoteUs = ((uint32_t)remote << TIMEBASE_UNIT_SHIFT) + TIMEBASE_UNIT_US / 2;
+    uint32_t sample = ((uint32_t)nowUs - remoteUs - TIMEBASE_MIN_DELAY_US) & (TIMEBASE_SPAN_US - 1);
+
+    // A jump away from the offset means the controller restarted (or its
+    // samples were lost for a long time): drop the samples of the old clock
+    // instead of letting the minimum filter hold on to them
+    if (timebaseCount_ > 0) {
+        long jump = span_delta(sample - timebaseOffset_);
+        if (jump > TIMEBASE_RESET_US || jump < -TIMEBASE_RESET_US) {
+            timebaseCount_ = 0;
+            timebaseIndex_ = 0;
+        }
+    }
+
+    // Samples closer together than the periodic broadcast are the burst the
+    // controller sends when it starts. Its clock may have moved by less than
+    // the reset threshold, so the window restarts from the burst instead of
+    // letting older samples hold the minimum.
+    bool burst = timebaseCount_ > 0 && nowUs - lastTimebaseTime_ < TIMEBASE_BURST_GAP_US;
+    if (burst && !timebaseBurst_) {
+        timebaseSamples_[0] = timebaseSamples_[(timebaseIndex_ + TIMEBASE_WINDOW - 1) %
+                                               TIMEBASE_WINDOW];
+        timebaseCount_ = 1;
+        timebaseIndex_ = 1;
+    }
+    timebaseBurst_ = burst;
+
+    timebaseSamples_[timebaseIndex_] = sample;
+    timebaseIndex_ = (timebaseIndex_ + 1) % TIMEBASE_WINDOW;
+    if (timebaseCount_ < TIMEBASE_WINDOW) timebaseCount_++;
+    lastTimebaseTime_ = nowUs;
+
+    // Minimum over the window, compared relative to the newest sample to
+    // stay correct across the timebase wrap
+    long minDelta = 0;
+    for (uint8_t i = 0; i < timebaseCount_; i++) {
+        long delta = span_delta(timebaseSamples_[i] - sample);
+        if (delta < minDelta) minDelta = delta;
+    }
+    timebaseOffset_ = (sample + minDelta) & (TIMEBASE_SPAN_US - 1);
+}
+
+bool SceneEngine::timebase_valid(unsigned long nowUs) {
+    if (timebaseSource_) return true;
+    return timebaseCount_ > 0 && nowUs - lastTimebaseTime_ < TIMEBASE_TIMEOUT_US;
+}
+
+void SceneEngine::set_timebase_source(bool source) {
+    if (source == timebaseSource_) return;
+    timebaseSource_ = source;
+    timebaseCount_ = 0;
+    timebaseIndex_ = 0;
+    timebaseBurst_ = false;
+    timebaseOffset_ = 0;
+}
+
+void SceneEngine::stop() {
+    fadeInProgress_ = false;
+    fadeScheduled_ = false;
+}
+
+bool SceneEngine::poll(unsigned long nowUs) {
+    // Hand over to a scheduled fade once its shared start time arrives
+    if (fadeScheduled_ && (long)(nowUs - schedStartTime_) >= 0) {
+        fadeScheduled_ = false;
+        begin_fade(schedStartTime_, schedDurationMs_, schedStream_, schedTarget_);
+    }
+
+    if (!fadeInProgress_) return false;
+
+    // Calculate progress (0.0 to 1.0); a re-timed fade may start slightly
+    // in the future and holds its start values until then
+    long elapsed = (long)(nowUs - fadeStartTime_);
+    float progress;
+    if (elapsed < 0) {
+        progress = 0.0f;
+    } else if ((unsigned long)elapsed >= fadeDurationMs_ * 1000UL) {
+        progress = 1.0f;
+    } else {
+        progress = (float)elapsed / ((float)fadeDurationMs_ * 1000.0f);
+    }
+
+    // Interpolate all channels
+    SceneValues next;
+    next.r = fadeStart_.r + (int16_t)(fadeTarget_.r - fadeStart_.r) * progress;
+    next.g = fadeStart_.g + (int16_t)(fadeTarget_.g - fadeStart_.g) * progress;
+    next.b = fadeStart_.b + (int16_t)(fadeTarget_.b - fadeStart_.b) * progress;
+    next.w = fadeStart_.w + (int16_t)(fadeTarget_.w - fadeStart_.w) * progress;
+    next.brightness = fadeStart_.brightness +
+                      (int16_t)(fadeTarget_.brightness - fadeStart_.brightness) * progress;
+
+    // A new fade redraws even without a change, to replace an uploaded frame
+    bool changed = next != current_ || redraw_;
+    current_ = next;
+    redraw_ = false;
+
+    // Check if fade is complete
+    if (progress >= 1.0f) {
+        fadeInProgress_ = false;
+        finished_ = !fadeStream_;
+    }
+    return changed;
+}
+
+bool SceneEngine::take_finished() {
+    bool finished = finished_;
+    finished_ = false;
+    return finished;
+}
+
+} // namespace openlcb
@@ -0,0 +1,191 @@
+#ifndef __SCENEENGINE_H
+#define __SCENEENGINE_H
+
+#include <stdint.h>
+
+namespace openlcb {
+
+/// Number of event channels per strip (R, G, B, W, Brightness, Duration, Stream,
+/// Timebase, Synchronized Duration, Frame, Start Epoch)
+static constexpr int NUM_CHANNELS = 11;
+
+/// Number of low event ID bits that carry the value for a channel
+/// (Stream, Timebase and Synchronized Duration carry 16 bits, all others 8)
+inline unsigned channel_value_bits(int channel) {
+    return (channel == 6 || channel == 7 || channel == 8) ? 16 : 8;
+}
+
+/// Mask selecting the value bits of a channel event ID
+inline uint64_t channel_value_mask(int channel) {
+    return (1ULL << channel_value_bits(channel)) - 1;
+}
+
+/// True if a board consumes the events of a channel: a Follower all of them,
+/// the Controller Duration, which it relays with a shared start time, and
+/// Frame, which presents a frame uploaded to its own pixel space
+inline bool channel_consumed(bool controller, int channel) {
+    return !controller || channel == 5 || channel == 9;
+}
+
+/// Solid color and brightness of a strip
+struct SceneValues {
+    uint8_t r, g, b, w, brightness;
+
+    bool operator==(const SceneValues &o) const {
+        return r == o.r && g == o.g && b == o.b && w == o.w && brightness == o.brightness;
+    }
+    bool operator!=(const SceneValues &o) const { return !(*this == o); }
+};
+
+/// Fade and shared timebase state of one strip.
+///
+/// Holds the pending values received over LCC, interpolates fades towards
+/// them and keeps the follower's view of the controller clock. It has no
+/// knowledge of the LEDs or the bus and takes the time (micros()) as a
+/// parameter, so the same code runs on the board and in the host tools.
+///
+/// The shared timebase counts in units of TIMEBASE_UNIT_US, mod 2^16. Fade
+/// triggers carry the low byte of their start time and are preceded by a
+/// Start Epoch event with the high byte.
+class SceneEngine {
+public:
+    SceneEngine();
+
+    /// Apply a channel event value received (or looped back) at nowUs, the
+    /// way every board decodes it. A Frame event (9) only stops fades.
+    void channel_event(unsigned long nowUs, int channel, uint16_t value);
+
+    /// Store a pending value (channel 0-4: R, G, B, W, Brightness)
+    void set_pending(int channel, uint8_t value);
+
+    /// Fade from the current to the pending values, starting now
+    void start_fade(unsigned long nowUs, unsigned long durationMs, bool stream);
+
+    /// Fade to the pending values starting at remoteStart, the controller
+    /// clock in timebase units. Starts now if there is no timebase.
+    void start_fade_at(unsigned long nowUs, uint16_t remoteStart,
+                       unsigned long durationMs, bool stream);
+
+    /// Add a controller clock sample (timebase units) received at nowUs
+    void timebase_sample(unsigned long nowUs, uint16_t remote);
+
+    /// Controller: this board's own clock is the shared timebase
+    void set_timebase_source(bool source);
+
+    /// True while recent controller clock samples are available
+    bool timebase_valid(unsigned long nowUs);
+
+    /// Stop running and scheduled fades, keeping the current values
+    void stop();
+
+    /// Advance the fade to nowUs. Returns true if the strip needs redrawing:
+    /// the current values changed, or a new fade started.
+    bool poll(unsigned long nowUs);
+
+    /// True once after a Duration fade (not a Stream fade) has finished
+    bool take_finished();
+
+    const SceneValues &current() { return current_; }
+    const SceneValues &pending() { return pending_; }
+    const SceneValues &fade_start() { return fadeStart_; }
+    const SceneValues &fade_target() { return fadeTarget_; }
+
+    bool fading() { return fadeInProgress_; }
+    bool scheduled() { return fadeScheduled_; }
+
+    /// Local micros() at which the running (or scheduled) fade starts
+    unsigned long fade_start_time() { return fadeScheduled_ ? schedStartTime_ : fadeStartTime_; }
+
+    /// The shared timebase (and a start time) for a local micros() value
+    static uint16_t timebase_units(unsigned long us) {
+        return (uint16_t)(us >> TIMEBASE_UNIT_SHIFT);
+    }
+
+    /// Stream event fade time unit (high byte of the value)
+    static constexpr unsigned long STREAM_FADE_UNIT_MS = 10;
+    /// The timebase counts micros() >> TIMEBASE_UNIT_SHIFT. A power of two
+    /// keeps it continuous across the 32-bit micros() wrap.
+    static constexpr unsigned TIMEBASE_UNIT_SHIFT = 7;
+    static constexpr unsigned long TIMEBASE_UNIT_US = 1UL << TIMEBASE_UNIT_SHIFT;
+    /// Span of the 16-bit timebase, about 8.4 s
+    static constexpr unsigned long TIMEBASE_SPAN_US = 0x10000UL << TIMEBASE_UNIT_SHIFT;
+    /// Controller clock samples kept for the minimum-delay filter
+    static constexpr uint8_t TIMEBASE_WINDOW = 8;
+    /// A sample this far from the current offset means the controller clock
+    /// restarted; the window is cleared so the stale offset is not kept
+    static constexpr long TIMEBASE_RESET_US = 250000;
+    /// Samples older than this are ignored (controller broadcasts every 1s)
+    static constexpr unsigned long TIMEBASE_TIMEOUT_US = 3500000;
+    /// Shortest time from stamping a sample to handling it on a follower,
+    /// by which every sample is late even with empty queues: the frame's bus
+    /// time (8 data bytes at 125 kbit/s, typical stuffing, 1120 us) plus the
+    /// fastest hand-off through the sender's driver and the receiver's
+    /// executor (about 250 us)
+    static constexpr unsigned long TIMEBASE_MIN_DELAY_US = 1370;
+    /// Samples the controller sends back to back after (re)starting, so the
+    /// first synchronized fade does not rest on a single, possibly late sample
+    static constexpr uint8_t TIMEBASE_BURST = 6;
+    /// Spacing of the burst samples, longer than a typical executor stall so
+    /// one stall does not delay the samples after it as well
+    static constexpr unsigned long TIMEBASE_BURST_INTERVAL_MS = 50;
+    /// Samples closer together than this belong to a startup burst
+    static constexpr unsigned long TIMEBASE_BURST_GAP_US = 250000;
+    /// Start times are sent this far ahead of the send time
+    static constexpr unsigned long FADE_START_LEAD_MS = 50;
+    /// A 16-bit start time resolves to [now - PAST, now + SPAN - PAST]. The
+    /// past side covers a trigger held back by a long burst of higher
+    /// priority traffic (an identify storm of a few hundred boards takes
+    /// under 2 s), the future side the lead plus any offset error.
+    static constexpr unsigned long START_WINDOW_PAST_US = 6000000;
+    /// A synchronized start for the fade already running re-times it
+    /// instead of restarting it, if that fade began within this window
+    static constexpr unsigned long RETIME_WINDOW_US = 250000;
+
+private:
+    /// Local micros() for a controller clock start time
+    unsigned long local_start(unsigned long nowUs, uint16_t remoteStart);
+
+    /// Fade trigger carrying the low byte of its start time: combine it with
+    /// the preceding Start Epoch, or start on receipt without one
+    void trigger(unsigned long nowUs, uint8_t startLow, unsigned long durationMs, bool stream);
+
+    /// Begin interpolating from the current values towards target
+    void begin_fade(unsigned long startTime, unsigned long durationMs, bool stream,
+                    const SceneValues &target);
+
+    SceneValues current_;              // What the LEDs show right now
+    SceneValues pending_;              // Received values waiting for a trigger
+
+    bool fadeInProgress_;
+    bool fadeStream_;                  // Started by a Stream event
+    bool finished_;                    // Duration fade finished, not yet reported
+    bool redraw_;                      // Fade started, not yet polled
+    unsigned long fadeStartTime_;      // micros() when fade started
+    unsigned long fadeDurationMs_;
+    SceneValues fadeStart_;
+    SceneValues fadeTarget_;
+
+    // Scheduled fade (waiting for its shared start time)
+    bool fadeScheduled_;
+    bool schedStream_;
+    unsigned long schedStartTime_;     // Local micros() at which the fade begins
+    unsigned long schedDurationMs_;
+    SceneValues schedTarget_;
+
+    // High byte of the next trigger's start time
+    bool epochValid_;
+    uint8_t epoch_;
+
+    // Shared timebase (view of the controller clock)
+    bool timebaseSource_;              // Controller: offset is 0 by definition
+    uint32_t timebaseSamples_[TIMEBASE_WINDOW];  // local - remote clock in us, mod SPAN
+    uint8_t timebaseCount_;
+    uint8_t timebaseIndex_;
+    bool timebaseBurst_;               // Newest sample was part of a startup burst
+    uint32_t timebaseOffset_;          // Best estimate of local - remote clock
+    unsigned long lastTimebaseTime_;   // Local time of the newest sample
+};
+
+} // namespace openlcb
+
+#endif // __SCENEENGINE_H
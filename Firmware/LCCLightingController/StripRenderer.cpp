@@ -0,0 +1,77 @@
+#include "StripRenderer.h"
+#include <string.h>
+
+namespace openlcb {
+
+StripRenderer::StripRenderer()
+    : pixels_(nullptr), count_(0), frame_(nullptr), color_{0, 0, 0, 0},
+      brightness_(255), frameMode_(false), dirty_(false), stale_(false),
+      applied_(255), lastShowMs_(0) {
+}
+
+StripRenderer::~StripRenderer() {
+    delete[] frame_;
+}
+
+void StripRenderer::attach(uint8_t *pixels, uint16_t count) {
+    pixels_ = pixels;
+    count_ = count;
+    delete[] frame_;
+    frame_ = new uint8_t[(size_t)count * BYTES_PER_PIXEL]();
+    frameMode_ = false;
+    limiter_.set_led_count(count);
+    limiter_.set_sum(0);
+}
+
+void StripRenderer::configure(uint16_t budgetMa, uint16_t channelMa) {
+    limiter_.configure(budgetMa, channelMa);
+    dirty_ = true;
+}
+
+void StripRenderer::show_scene(const SceneValues &v) {
+    color_[0] = v.w;
+    color_[1] = v.r;
+    color_[2] = v.g;
+    color_[3] = v.b;
+    brightness_ = v.brightness;
+    frameMode_ = false;
+    limiter_.on_fill(v.r, v.g, v.b, v.w);
+    dirty_ = stale_ = true;
+}
+
+void StripRenderer::show_frame(FrameBuffer &frame) {
+    // Keep a full brightness copy: the power limit scales it into the
+    // strip, and the frame buffer may already change for the next upload
+    limiter_.set_sum(frame.commit(frame_));
+    brightness_ = 255;
+    frameMode_ = true;
+    dirty_ = stale_ = true;
+}
+
+bool StripRenderer::flush(unsigned long nowMs) {
+    if (!pixels_ || (!dirty_ && !limiter_.recovering())) return false;
+    if (nowMs - lastShowMs_ < MIN_SHOW_INTERVAL_MS) return false;
+
+    // Cap brightness to the power budget just before the frame is shown
+    uint8_t cap = limiter_.limit();
+    uint8_t target = brightness_ < cap ? brightness_ : cap;
+    if (stale_ || target != applied_) {
+        size_t size = (size_t)count_ * BYTES_PER_PIXEL;
+        if (frameMode_) {
+            PowerLimiter::scale(frame_, pixels_, size, target);
+        } else {
+            uint8_t scaled[BYTES_PER_PIXEL];
+            PowerLimiter::scale(color_, scaled, BYTES_PER_PIXEL, target);
+            for (size_t i = 0; i < size; i += BYTES_PER_PIXEL) {
+                memcpy(pixels_ + i, scaled, BYTES_PER_PIXEL);
+            }
+        }
+        applied_ = target;
+        stale_ = false;
+    }
+    lastShowMs_ = nowMs;
+    dirty_ = false;
+    return true;
+}
+
+} // namespace openlcb
@@ -0,0 +1,74 @@
+#ifndef __STRIPRENDERER_H
+#define __STRIPRENDERER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FrameBuffer.h"
+#include "PowerLimiter.h"
+#include "SceneEngine.h"
+
+namespace openlcb {
+
+/// Render stage between the fade engine (or an uploaded frame) and the LEDs.
+///
+/// Fills the strip's pixel buffer with the current scene, or with the
+/// committed frame, at the requested brightness capped by the power limit,
+/// and paces show() calls. The buffer is written in wire order (W, R, G, B)
+/// at its final brightness, so the NeoPixel library only sends it; the
+/// scene and the frame are kept at full brightness and scaled from there,
+/// so a cap that dips and recovers never wears them down. Has no knowledge
+/// of the LEDs and takes the time as a parameter, so the host tools run the
+/// same code as the board.
+class StripRenderer {
+public:
+    static constexpr size_t BYTES_PER_PIXEL = FrameBuffer::BYTES_PER_PIXEL;
+    /// Minimum time between show() calls (60 fps); the LEDs need time to
+    /// latch each transfer
+    static constexpr unsigned long MIN_SHOW_INTERVAL_MS = 16;
+
+    StripRenderer();
+    ~StripRenderer();
+
+    /// Render into pixels, the strip buffer of count LEDs. Drops any frame.
+    void attach(uint8_t *pixels, uint16_t count);
+
+    /// Current budget (0 = disabled) and per-channel LED current; the cap
+    /// is re-evaluated at the next flush
+    void configure(uint16_t budgetMa, uint16_t channelMa);
+
+    /// Show a solid scene
+    void show_scene(const SceneValues &v);
+
+    /// Show the frame committed from frame, at full brightness
+    void show_frame(FrameBuffer &frame);
+
+    /// Bring the strip buffer up to date if a show is due at nowMs. Returns
+    /// true if the caller should show() it now; false if nothing changed or
+    /// the last show was too recent (the change is kept for the next call).
+    bool flush(unsigned long nowMs);
+
+    /// Showing an uploaded frame instead of a scene
+    bool frame_mode() const { return frameMode_; }
+
+    /// Brightness the strip buffer was last rendered at
+    uint8_t applied() const { return applied_; }
+
+    PowerLimiter &limiter() { return limiter_; }
+
+private:
+    uint8_t *pixels_;                  // Strip buffer (not owned)
+    uint16_t count_;
+    uint8_t *frame_;                   // Committed frame at full brightness
+    uint8_t color_[BYTES_PER_PIXEL];   // Scene colour in wire order at full brightness
+    uint8_t brightness_;               // Requested brightness before the power limit
+    bool frameMode_;
+    bool dirty_;                       // Contents changed since the last show
+    bool stale_;                       // Strip buffer must be refilled
+    uint8_t applied_;
+    unsigned long lastShowMs_;
+    PowerLimiter limiter_;
+};
+
+} // namespace openlcb
+
+#endif // __STRIPRENDERER_H
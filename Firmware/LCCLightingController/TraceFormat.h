@@ -0,0 +1,45 @@
+#ifndef __TRACEFORMAT_H
+#define __TRACEFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace openlcb {
+
+/// Layout of the event trace dump, shared by EventTrace and the host replay.
+///
+/// The dump (serial and memory space) is a 16 byte header followed by the
+/// records, oldest first. All fields are little-endian.
+///
+///   Header: "LCCT", version (3), record size (13), capacity (u16),
+///           count (u16), dropped (u16), flags (u8, bit 0 = controller),
+///           3 reserved bytes
+///   Record: micros() timestamp (u32), flags (u8, bit 0 = sent, bits 1-4 =
+///           strip channel + 1, 0 for other events), full event ID (u64)
+///
+/// Over serial the dump is sent as text lines, "@T" followed by the offset
+/// and up to TRACE_LINE_BYTES bytes in hex, then "@T END".
+static constexpr char TRACE_MAGIC[] = "LCCT";
+static constexpr uint8_t TRACE_FORMAT_VERSION = 3;
+static constexpr size_t TRACE_HEADER_SIZE = 16;
+static constexpr size_t TRACE_RECORD_SIZE = 13;
+
+// Header field offsets
+static constexpr size_t TRACE_VERSION_OFFSET = 4;
+static constexpr size_t TRACE_RECORD_SIZE_OFFSET = 5;
+static constexpr size_t TRACE_CAPACITY_OFFSET = 6;
+static constexpr size_t TRACE_COUNT_OFFSET = 8;
+static constexpr size_t TRACE_DROPPED_OFFSET = 10;
+static constexpr size_t TRACE_FLAGS_OFFSET = 12;
+static constexpr uint8_t TRACE_HEADER_FLAG_CONTROLLER = 0x01;
+
+// Record flags
+static constexpr uint8_t TRACE_FLAG_SENT = 0x01;
+static constexpr uint8_t TRACE_CHANNEL_SHIFT = 1;  // Strip channel + 1
+
+/// Dump bytes per serial line
+static constexpr size_t TRACE_LINE_BYTES = 32;
+
+} // namespace openlcb
+
+#endif // __TRACEFORMAT_H
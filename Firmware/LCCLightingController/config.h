@@ -7,6 +7,7 @@
 #include "openlcb/MemoryConfig.hxx"
 
 #include "RGBWConfig.h"
+#include "AdcInputConfig.h"
 
 namespace openlcb
 {
@@ -31,6 +32,12 @@ constexpr uint8_t NUM_RGBW_STRIPS = 1;
 /// Declares a repeated group of RGBW strip configurations
 using RGBWGroup = RepeatedGroup<RGBWConfig, NUM_RGBW_STRIPS>;
 
+/// Up to four ADS1115 chips with four inputs each
+constexpr uint8_t NUM_ADC_INPUTS = 16;
+
+/// Declares a repeated group of control panel input configurations
+using AdcInputGroup = RepeatedGroup<AdcInputConfig, NUM_ADC_INPUTS>;
+
 /// Initial values for RGBW configuration
 constexpr uint64_t RGBW_EVENT_INIT[] = {
     0x050101019F600000ULL,  // Red base
@@ -38,12 +45,17 @@ constexpr uint64_t RGBW_EVENT_INIT[] = {
     0x050101019F600200ULL,  // Blue base
     0x050101019F600300ULL,  // White base
     0x050101019F600400ULL,  // Brightness base
-    0x050101019F600500ULL   // Duration base (triggers fade)
+    0x050101019F600500ULL,  // Duration base (triggers fade)
+    0x050101019F630000ULL,  // Stream base (short fade: 10ms units << 8 | start time low byte)
+    0x050101019F610000ULL,  // Timebase base (16-bit controller clock, 128 us units)
+    0x050101019F620000ULL,  // Synchronized duration base (seconds << 8 | start time low byte)
+    0x050101019F600700ULL,  // Frame commit base (shows uploaded pixel frame)
+    0x050101019F600600ULL   // Start epoch base (high byte of the next fade start time)
 };
 
 /// Modify this value every time the EEPROM needs to be cleared on the node
 /// after an update. Increment when config structure changes (fields added/removed).
-static constexpr uint16_t CANONICAL_VERSION = 0x107;
+static constexpr uint16_t CANONICAL_VERSION = 0x10E;
 
 /// Defines the main segment in the configuration CDI. This is laid out at
 /// origin 128 to give space for the ACDI user data at the beginning.
@@ -51,6 +63,9 @@ CDI_GROUP(IoBoardSegment, Segment(MemoryConfigDefs::SPACE_CONFIG), Offset(128));
 /// Each entry declares the name of the current entry, then the type and then
 /// optional arguments list.
 CDI_GROUP_ENTRY(rgbw_strips, RGBWGroup, Name("RGBW Light Strips"), RepName("Strip"));
+CDI_GROUP_ENTRY(adc_inputs, AdcInputGroup, Name("Control Panel Inputs"),
+    Description("Controller only: ADS1115 inputs, four per chip. Inputs 1-4 are the chip at I2C address 0x48, 5-8 at 0x49, 9-12 at 0x4A and 13-16 at 0x4B."),
+    RepName("Input"));
 CDI_GROUP_ENTRY(internal_config, InternalConfigData);
 CDI_GROUP_END();
 